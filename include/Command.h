@@ -0,0 +1,143 @@
+#ifndef GW1K_COMMAND_H_
+#define GW1K_COMMAND_H_
+
+namespace gw1k
+{
+
+
+class CommandQueue;
+
+
+/**
+ * A unit of work that is posted to WManager's CommandQueue (possibly from
+ * another thread) and executed on the GUI thread at the beginning of the next
+ * WManager::render() call.
+ *
+ * Derive from Command and implement execute() for custom actions, or use
+ * makeCommand() to call a setter method of a widget.
+ */
+class Command
+{
+
+    friend class CommandQueue;
+
+public:
+
+    /**
+     * target is the object affected by the command; it is used to find
+     * commands that may be coalesced (see isSameUpdate()) and to drop the
+     * commands of deleted objects (see CommandQueue::removeCommands()). It may
+     * be 0.
+     */
+    Command(const void* target = 0)
+    :   target_(target),
+        next_(0)
+    {}
+
+    virtual ~Command() {}
+
+public:
+
+    virtual void execute() = 0;
+
+    /**
+     * Returns true if this command and the (earlier posted) command other
+     * update the same property of the same target, in which case only the
+     * later one is executed. The default implementation returns false, so
+     * commands are not coalesced.
+     */
+    virtual bool isSameUpdate(const Command& other) const
+    {
+        return false;
+    }
+
+    const void* getTarget() const
+    {
+        return target_;
+    }
+
+private:
+
+    const void* target_;
+
+    /** Link used by CommandQueue */
+    Command* next_;
+
+};
+
+
+/**
+ * Calls a one-argument method of an object, with the argument stored in the
+ * command. Commands calling the same method of the same object are coalesced,
+ * so only the last posted value is applied.
+ *
+ * Stored is the type the argument is kept as; it differs from Arg for methods
+ * taking const references (e.g. Label::setText()).
+ */
+template<typename T, typename Arg, typename Stored = Arg>
+class MethodCommand : public Command
+{
+
+public:
+
+    typedef void (T::*Method)(Arg);
+
+    MethodCommand(T* obj, Method method, const Stored& arg)
+    :   Command(obj),
+        obj_(obj),
+        method_(method),
+        arg_(arg)
+    {}
+
+public:
+
+    virtual void execute()
+    {
+        (obj_->*method_)(arg_);
+    }
+
+    virtual bool isSameUpdate(const Command& other) const
+    {
+        const MethodCommand* o = dynamic_cast<const MethodCommand*>(&other);
+        return o && (o->obj_ == obj_) && (o->method_ == method_);
+    }
+
+private:
+
+    T* obj_;
+
+    Method method_;
+
+    Stored arg_;
+
+};
+
+
+/**
+ * Creates a MethodCommand for a method taking its argument by value, e.g.:
+ * makeCommand(slider, &Slider::setValue, 0.5f)
+ */
+template<typename T, typename A>
+inline Command*
+makeCommand(T* obj, void (T::*method)(A), A arg)
+{
+    return new MethodCommand<T, A>(obj, method, arg);
+}
+
+
+/**
+ * Creates a MethodCommand for a method taking a const reference; the argument
+ * is copied into the command, e.g.:
+ * makeCommand(label, &Label::setText, std::string("42"))
+ */
+template<typename T, typename A>
+inline Command*
+makeCommand(T* obj, void (T::*method)(const A&), const A& arg)
+{
+    return new MethodCommand<T, const A&, A>(obj, method, arg);
+}
+
+
+} // namespace gw1k
+
+#endif // GW1K_COMMAND_H_
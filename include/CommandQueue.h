@@ -0,0 +1,151 @@
+#ifndef GW1K_COMMANDQUEUE_H_
+#define GW1K_COMMANDQUEUE_H_
+
+#include "Command.h"
+
+#include <vector>
+
+namespace gw1k
+{
+
+
+/**
+ * A lock-free multiple-producer/single-consumer queue of Commands.
+ *
+ * Any thread may call post(); the commands are executed in posting order by
+ * execute(), which must only be called from the GUI thread (WManager does so at
+ * the beginning of render()). Commands for which Command::isSameUpdate() holds
+ * are coalesced when executed, i.e., only the last one posted is executed and
+ * the earlier ones are dropped.
+ *
+ * Producers never block: posting is a single compare-and-swap on the queue
+ * head. If a capacity is set and the number of pending commands reaches it,
+ * post() rejects further commands until the queue has been drained.
+ */
+class CommandQueue
+{
+
+public:
+
+    /**
+     * Counters describing the queue's activity since its creation (or the
+     * last call to resetStats(), except for pending).
+     */
+    struct Stats
+    {
+        unsigned long posted;
+
+        unsigned long executed;
+
+        /** Commands dropped because a later one updated the same property */
+        unsigned long coalesced;
+
+        /** Commands rejected because the queue was full */
+        unsigned long rejected;
+
+        /** Commands posted, but not executed yet */
+        unsigned int pending;
+
+        /** The highest number of pending commands observed */
+        unsigned int maxPending;
+    };
+
+public:
+
+    CommandQueue();
+
+    /**
+     * Deletes all pending commands without executing them.
+     */
+    ~CommandQueue();
+
+public:
+
+    /**
+     * Posts a command. The queue takes ownership of c and deletes it after
+     * execution. Returns false if the queue is full, in which case c is
+     * deleted right away. This method is safe to call from any thread.
+     */
+    bool post(Command* c);
+
+    /**
+     * Executes all commands posted so far. Must only be called from the GUI
+     * thread.
+     */
+    void execute();
+
+    /**
+     * Deletes all pending commands whose target (see Command::getTarget()) is
+     * in targets, which must be sorted, without executing them. Must only be
+     * called from the GUI thread.
+     */
+    void removeCommands(const std::vector<const void*>& targets);
+
+    /**
+     * Deletes all pending commands for the given target, see above. This does
+     * not allocate memory, so it is cheap to call for every deleted object.
+     */
+    void removeCommands(const void* target);
+
+    /**
+     * Sets the maximum number of pending commands. 0 (the default) means no
+     * limit.
+     */
+    void setCapacity(unsigned int capacity);
+
+    unsigned int getCapacity() const;
+
+    Stats getStats() const;
+
+    void resetStats();
+
+private:
+
+    CommandQueue(const CommandQueue&) {}
+
+    CommandQueue& operator=(const CommandQueue&) { return *this; }
+
+    /**
+     * Atomically takes all posted commands and returns them in posting order.
+     */
+    Command* takeAll();
+
+    static void deleteAll(Command* c);
+
+    /**
+     * Deletes all pending commands whose target is in the sorted range
+     * [begin, end).
+     */
+    void removeCommands(const void* const* begin, const void* const* end);
+
+private:
+
+    /** Most recently posted command; commands are linked via next_ */
+    Command* volatile head_;
+
+    /**
+     * Commands taken from the queue by removeCommands() but not executed yet,
+     * in posting order; only accessed by the GUI thread
+     */
+    Command* backlog_;
+
+    volatile unsigned int capacity_;
+
+    volatile unsigned int pending_;
+
+    volatile unsigned int maxPending_;
+
+    volatile unsigned long posted_;
+
+    unsigned long executed_;
+
+    unsigned long coalesced_;
+
+    volatile unsigned long rejected_;
+
+};
+
+
+} // namespace gw1k
+
+#endif // GW1K_COMMANDQUEUE_H_
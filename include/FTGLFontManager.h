@@ -6,39 +6,331 @@
 #define GW1K_FTGLFONTMANAGER_H_
 
 
+#include "listeners/TimerListener.h"
+
+#include <list>
 #include <map>
+#include <set>
 #include <string>
+#include <vector>
 #include <FTGL/ftgl.h>
 
 namespace gw1k
 {
 
 
-class FTGLFontManager
+class FontDataCommand;
+
+
+class FTGLFontManager : public TimerListener
 {
 
+    friend class FontDataCommand;
+
 public:
 
+    struct PreloadReport
+    {
+        /** Number of fonts (face and size) created */
+        unsigned int fonts;
+
+        /** Number of glyphs (UTF-8 characters) warmed up */
+        unsigned int glyphs;
+
+        /** Number of font requests that failed */
+        unsigned int failed;
+
+        /** Time spent on the GUI thread creating fonts and glyphs, in s */
+        double warmupTime;
+
+        /** Time from StartPreloading() until all fonts were available, in s */
+        double totalTime;
+    };
+
+    struct CacheStats
+    {
+        /** Number of cached fonts (face and size) */
+        unsigned int fonts;
+
+        /** Number of cached fonts that are in use by at least one Text */
+        unsigned int referencedFonts;
+
+        /** Estimated memory of the glyph textures of all cached fonts */
+        unsigned long bytes;
+
+        /** Memory budget, or 0 if unlimited */
+        unsigned long budget;
+
+        /** Number of GetFont() calls served from the cache */
+        unsigned long hits;
+
+        /** Number of GetFont() calls that created a font */
+        unsigned long misses;
+
+        /** Number of fonts deleted to stay within the budget */
+        unsigned long evictions;
+    };
+
     static FTGLFontManager& Instance();
 
     ~FTGLFontManager();
 
+    /**
+     * Gets the font of the given face and size, creating it if necessary.
+     * Creating a font may delete the least recently used fonts that are not
+     * referenced (see AcquireFont()) if the memory budget is exceeded, so
+     * users that keep the returned font should acquire it right away.
+     */
     FTFont* GetFont(const char *filename, int size);
 
+    /**
+     * Marks font as in use, so it is not evicted from the cache. Each call
+     * must be matched by a call to ReleaseFont().
+     */
+    void AcquireFont(FTFont* font);
+
+    void ReleaseFont(FTFont* font);
+
+    /**
+     * Sets the estimated memory (in bytes) the glyph textures of all cached
+     * fonts may take before unreferenced fonts are evicted, least recently
+     * used first. 0 means unlimited. The default is 32 MiB. Fonts that are
+     * referenced are never evicted, so the budget may still be exceeded.
+     */
+    void SetMemoryBudget(unsigned long bytes);
+
+    CacheStats GetCacheStats() const;
+
+    /**
+     * Gets the font to render text of the given face and size with. If scaled
+     * rendering is disabled (default), this is the same as GetFont() and scale
+     * is set to 1. Otherwise, the size is mapped to one of a few rendering
+     * sizes per face (16, 32, 64 and 128; larger sizes are used as they are),
+     * and scale receives the factor by which the font's glyphs have to be
+     * scaled to appear in the requested size. Text of arbitrary sizes is thus
+     * rendered from a handful of glyph textures per face.
+     */
+    FTFont* GetRenderFont(const char* filename, int size, float& scale);
+
+    /**
+     * Enables or disables scaled rendering (see GetRenderFont()). This only
+     * affects fonts that are set after the call.
+     */
+    void SetScaledRendering(bool enabled);
+
+    bool IsScaledRendering() const;
+
+    /**
+     * Gets the bounding box of text as laid out by layout. Results are cached
+     * per font (i.e., font file and size), line length, alignment, line
+     * spacing and text, so measuring the same content again is cheap. The
+     * least recently used entries are dropped when the cache exceeds its
+     * maximum size.
+     */
+    FTBBox MeasureText(FTSimpleLayout& layout, const std::string& text);
+
+    /**
+     * Sets the maximum number of cached text measurements. 0 disables the
+     * cache. The default is 4096.
+     */
+    void SetMeasureCacheSize(unsigned int maxEntries);
+
+    /**
+     * Adds a font (face and size) to be loaded by StartPreloading(). The
+     * glyphs in glyphs are rasterised right after the font is created, so the
+     * first frame that renders them does not stall. size is the face size as
+     * passed to GetRenderFont(), i.e., scaled rendering is taken into account.
+     * Preloaded fonts are acquired (see AcquireFont()), so they are never
+     * evicted from the cache.
+     */
+    void AddPreload(const char* filename, int size, const std::string& glyphs);
+
+    /**
+     * Starts loading the font files of all fonts added by AddPreload() on a
+     * background thread. The fonts and their glyphs are created on the GUI
+     * thread (as they need the GL context) once their files have been read,
+     * through WManager's command queue. The GUI thread polls for the end of
+     * the run by a WManager timer, and logs a report when all fonts are
+     * available.
+     */
+    void StartPreloading();
+
+    /**
+     * Returns whether preloading has been started and is not finished yet.
+     */
+    bool IsPreloading() const;
+
+    /**
+     * Waits for the preload thread to finish and drops the fonts of the
+     * current preloading run that have not been created yet. Must be called
+     * before WManager is destroyed, as the preload thread posts to its command
+     * queue.
+     */
+    void CancelPreloading();
+
+    /**
+     * Gets the report of the last (finished) preloading run.
+     */
+    const PreloadReport& GetPreloadReport() const;
+
     void cleanup();
 
 private:
 
+    struct PreloadRequest
+    {
+        std::string filename;
+
+        int size;
+
+        std::string glyphs;
+    };
+
+    typedef std::vector<unsigned char> FaceData;
+
+    struct FontEntry
+    {
+        FTFont* font;
+
+        /** Number of AcquireFont() calls not yet matched by ReleaseFont() */
+        unsigned int refs;
+
+        /** Value of useCounter_ at the last GetFont() call for this font */
+        unsigned long lastUse;
+
+        /** Estimated memory of the font's glyph textures */
+        unsigned long bytes;
+    };
+
+    /** Fonts by face file name and size */
+    typedef std::map<std::pair<std::string, int>, FontEntry> FontList;
+
+    /**
+     * Deletes unreferenced fonts, least recently used first, until the
+     * cached fonts fit into the memory budget or only referenced fonts are
+     * left.
+     */
+    void evictFonts();
+
+    /**
+     * Deletes the font of entry and drops everything cached for it.
+     */
+    void removeFont(FontList::iterator entry);
+
+    /**
+     * Called on the GUI thread when the file of a preloaded face has been
+     * read. Takes ownership of data.
+     */
+    void createPreloadedFonts(const std::string& filename, FaceData* data);
+
+    void finishPreloading();
+
+    /**
+     * Polls whether the preload thread has finished.
+     */
+    virtual void timerExpired(int token);
+
+    /**
+     * Creates the font of r and its glyphs, and updates the preload report.
+     */
+    void warmUp(const PreloadRequest& r);
+
+    struct MeasureKey
+    {
+        FTFont* font;
+
+        float lineLength;
+
+        float lineSpacing;
+
+        int alignment;
+
+        std::string text;
+
+        bool operator<(const MeasureKey& rhs) const;
+    };
+
+    typedef std::list<std::pair<MeasureKey, FTBBox> > MeasureList;
+
+    typedef std::map<MeasureKey, MeasureList::iterator> MeasureMap;
+
     // Hide these 'cause this is a singleton.
 
-    FTGLFontManager() {};
+    FTGLFontManager()
+    :   useCounter_(0),
+        bytes_(0),
+        memoryBudget_(32 * 1024 * 1024),
+        hits_(0),
+        misses_(0),
+        evictions_(0),
+        maxMeasureEntries_(4096),
+        bScaledRendering_(false),
+        preloadThread_(-1),
+        preloadThreadDone_(0),
+        preloadStartTime_(0.0),
+        preloadReport_()
+    {};
 
     FTGLFontManager(const FTGLFontManager&) {};
 
     FTGLFontManager& operator=(const FTGLFontManager&) { return *this; };
 
     // container for fonts
-    std::map<std::string, FTFont*> fonts_;
+    FontList fonts_;
+
+    /** Look-up of a font's entry in fonts_ */
+    std::map<FTFont*, FontList::iterator> fontEntries_;
+
+    unsigned long useCounter_;
+
+    /** Estimated memory of all cached fonts */
+    unsigned long bytes_;
+
+    unsigned long memoryBudget_;
+
+    unsigned long hits_;
+
+    unsigned long misses_;
+
+    unsigned long evictions_;
+
+    /** Cached measurements, most recently used first */
+    MeasureList measureList_;
+
+    MeasureMap measureMap_;
+
+    unsigned int maxMeasureEntries_;
+
+    bool bScaledRendering_;
+
+    /**
+     * Contents of font files read by the preload thread; fonts created from
+     * these reference the data, so it is kept until cleanup()
+     */
+    std::map<std::string, FaceData*> faceData_;
+
+    /** Requests added by AddPreload() for the next preloading run */
+    std::vector<PreloadRequest> preloadRequests_;
+
+    /** Requests of the current preloading run */
+    std::vector<PreloadRequest> activePreloads_;
+
+    /** Handle of the preload thread, or -1 if not preloading */
+    int preloadThread_;
+
+    /**
+     * Set by the preload thread after it has posted its last command; polled
+     * rather than signalled through the command queue, as the queue may
+     * reject commands when full
+     */
+    volatile int preloadThreadDone_;
+
+    double preloadStartTime_;
+
+    PreloadReport preloadReport_;
+
+    /** Fonts acquired by preloading runs */
+    std::set<FTFont*> preloadedFonts_;
 
 };
 
@@ -0,0 +1,139 @@
+#ifndef GW1K_GLDIAGNOSTICS_H_
+#define GW1K_GLDIAGNOSTICS_H_
+
+#include <GL/glew.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gw1k
+{
+
+
+/**
+ * Collects OpenGL errors without stalling the pipeline.
+ *
+ * If KHR_debug (or ARB_debug_output) is available and the context is a debug
+ * context, enable() installs a message callback, and the driver reports errors
+ * as they happen; check points then only remember where rendering currently
+ * is, without any GL call. Otherwise,
+ * check points call glGetError(), so they should be placed at coarse points
+ * (gw1k itself only has a few per frame, none per widget).
+ *
+ * Errors are aggregated per call site: a message from the callback is counted
+ * for the last check point passed (unless synchronous output is enabled, the
+ * driver may report it a little later, though), an error found by
+ * glGetError() for the check point that found it. The first occurrence of an
+ * error at a site is logged at the next check point (the callback may run on a
+ * driver thread, so it doesn't log itself), and report() logs all sites with
+ * their counts.
+ *
+ * Check points are usually placed with the PRINT_IF_GL_ERROR macro (see
+ * GLErrorCheck.h), which compiles to nothing unless enabled.
+ */
+class GLDiagnostics
+{
+
+public:
+
+    /**
+     * Installs the debug message callback if supported; requires a GL context.
+     * With bSynchronous, messages are reported within the offending call, which
+     * makes the attribution to check points exact, but slows down rendering.
+     * Returns whether the callback is used, which requires a debug context
+     * (e.g., requested by GLFW_OPENGL_DEBUG_CONTEXT in
+     * GLFWApp::setupWindowHints()), as many drivers send no messages otherwise.
+     */
+    static bool enable(bool bSynchronous = false);
+
+    static bool isCallbackEnabled();
+
+    /**
+     * Marks a check point at the given source location.
+     */
+    static void checkPoint(const char* file, int line);
+
+    /**
+     * Gets the number of errors recorded since the last report().
+     */
+    static unsigned long getErrorCount();
+
+    /**
+     * Logs all recorded errors with their call sites and counts, and clears
+     * them.
+     */
+    static void report();
+
+private:
+
+    /**
+     * Counts an error at the given site; the caller must hold lock_.
+     */
+    static void record(const char* file,
+                       int line,
+                       unsigned int id,
+                       const std::string& msg);
+
+    /**
+     * Logs the first occurrences recorded since the last call; must be called
+     * on the GUI thread without holding lock_.
+     */
+    static void logNewErrors();
+
+    static void GLAPIENTRY messageCallback(GLenum source,
+                                           GLenum type,
+                                           GLuint id,
+                                           GLenum severity,
+                                           GLsizei length,
+                                           const GLchar* message,
+                                           const void* userParam);
+
+private:
+
+    /** A call site and error (GL error code or debug message ID) */
+    struct Key
+    {
+        const char* file;
+
+        int line;
+
+        unsigned int id;
+
+        bool operator<(const Key& k) const;
+    };
+
+    struct Entry
+    {
+        std::string msg;
+
+        unsigned long count;
+    };
+
+    static bool bCallbackEnabled_;
+
+    /** The last check point passed */
+    static const char* volatile siteFile_;
+
+    static volatile int siteLine_;
+
+    static std::map<Key, Entry> errors_;
+
+    static unsigned long errorCount_;
+
+    /** First occurrences of errors, to be logged by logNewErrors() */
+    static std::vector<std::string> newErrors_;
+
+    /**
+     * Spin lock guarding the check point, errors_, errorCount_ and
+     * newErrors_, since the driver may call messageCallback() from another
+     * thread
+     */
+    static volatile int lock_;
+
+};
+
+
+} // namespace gw1k
+
+#endif // GW1K_GLDIAGNOSTICS_H_
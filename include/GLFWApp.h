@@ -4,7 +4,9 @@
 #include <GL/glew.h>
 #include <GL/glfw.h>
 
+#include "InputRecorder.h"
 #include "Point.h"
+#include "RenderPipeline.h"
 
 namespace gw1k
 {
@@ -76,6 +78,27 @@ public:
      */
     void mainLoop();
 
+    /**
+     * Starts writing all input received through the GLFW callbacks, as well
+     * as the frames rendered by mainLoop(), to the given file (see
+     * InputRecorder). Returns false if the file cannot be written.
+     */
+    bool startInputRecording(const char* filename);
+
+    void stopInputRecording();
+
+    /**
+     * Replays input recorded with startInputRecording() as fast as possible:
+     * each event is passed to the respective event handler (e.g.,
+     * mouseMoveEvent()), and a frame is rendered (without swapping buffers)
+     * where one was rendered during recording. Timers run on a virtual clock
+     * that follows the recorded event times, so they fire in the same places
+     * as during recording. Logs the dispatch latency per event type and the
+     * frame times when done. Returns false if the file cannot be read.
+     * Call this instead of mainLoop(), after init() and any application setup.
+     */
+    bool replayInput(const char* filename);
+
 protected:
 
     /**
@@ -151,6 +174,14 @@ protected:
      */
     virtual void getWindowParams(int& r, int& g, int& b, int& a, int& depthBits, int& stencilBits);
 
+    /**
+     * Override this to choose the render path (see RenderPipeline.h), which is
+     * selected right after the window has been created. If the shader path is
+     * not supported, the fixed-function path is used.
+     * The default implementation chooses the fixed-function path.
+     */
+    virtual RenderPath getPreferredRenderPath();
+
     /**
      * Calls WManager::setWindowSize() and sets OpenGL viewport.
      * Override this method to implement a custom resize handler.
@@ -186,7 +217,8 @@ private:
     /**
      * Creates the application window, querying for custom settings by calling
      * getInitialWindowSize(), setupWindowHints(), and getWindowParams() before.
-     * After this, calls registerGLFWCallbacks() and enables vertical sync (via
+     * After this, selects the render path returned by getPreferredRenderPath(),
+     * calls registerGLFWCallbacks() and enables vertical sync (via
      * glfwSwapInterval()).
      */
     int setupGLFW();
@@ -196,6 +228,12 @@ private:
      */
     void registerGLFWCallbacks();
 
+    /**
+     * Records an input event if recording, with the time since the recording
+     * started.
+     */
+    void recordInput(InputEvent::Type type, int a = 0, int b = 0);
+
 public:
 
     static void GLFWCALL resizeWindowCallback(int width, int height);
@@ -215,6 +253,11 @@ private:
      */
     static GLFWApp* pInstance_;
 
+    InputRecorder recorder_;
+
+    /** glfwGetTime() when the recording was started */
+    double recordingStart_;
+
 };
 
 } // namespace gw1k
@@ -16,11 +16,19 @@ namespace gw1k
 {
 
 
+class Layout;
+struct MemoryFootprint;
+
+
 class GuiObject : public MouseEventProvider, public KeyEventProvider,
         public DraggedEventProvider, public ResizedEventProvider,
         public TimerListener
 {
 
+    friend class Layout;
+    friend class MemoryReport;
+    friend class WidgetSnapshot;
+
 public:
 
     GuiObject();
@@ -108,10 +116,41 @@ public:
 
     bool isClickThrough() const;
 
+    /**
+     * Sets whether this widget can receive the keyboard focus, either by being
+     * clicked or by Tab traversal (see WManager::setFocus()). Widgets are not
+     * focusable by default.
+     */
+    void setFocusable(bool state = true);
+
+    bool isFocusable() const;
+
+    /**
+     * Sets the focused status. This is called by WManager when the keyboard
+     * focus changes; use WManager::setFocus() to actually move the focus.
+     */
+    void setFocused(bool state = true);
+
+    bool isFocused() const;
+
+    /**
+     * Appends all visible and interactive focusable objects of this object's
+     * sub-tree (including this object) to v, in render order. This order is
+     * used as tab order by WManager.
+     */
+    void collectFocusableObjects(std::vector<GuiObject*>& v);
+
     void triggerMouseMovedEvent(MouseMovedEvent ev,
                                 const Point& pos,
                                 const Point& delta);
 
+    /**
+     * Like triggerMouseMovedEvent() with GW1K_M_HOVERED, but only informs the
+     * listeners that opted in to hover events (see
+     * MouseEventProvider::addMouseListener()).
+     */
+    void triggerMouseHoveredEvent(const Point& pos, const Point& delta);
+
     /**
      * In order to have resizing working correctly, calls to
      * setClickedPos() should be performed previous to calling this
@@ -121,14 +160,38 @@ public:
 
     void triggerMouseWheelEvent(int delta);
 
+    void triggerKeyEvent(int key, StateEvent ev);
+
     void triggerDraggedEvent(const Point& delta);
 
     void triggerResizedEvent(const Point& delta);
 
     virtual void addSubObject(GuiObject* o);
 
+    /**
+     * Removes the given sub-object. The sub-object is found in constant time;
+     * closing the gap in the sub-object list (which keeps the render order)
+     * takes time proportional to the number of sub-objects behind it.
+     */
     virtual void removeSubObject(GuiObject* o);
 
+    /**
+     * Removes all given sub-objects in a single pass over the sub-object list,
+     * which is considerably faster than removing many sub-objects one by one.
+     * Objects that are not sub-objects of this object are ignored with a
+     * warning.
+     */
+    virtual void removeSubObjects(const std::vector<GuiObject*>& objects);
+
+    /**
+     * Removes and deletes all given sub-objects, see removeSubObjects(). Only
+     * the objects actually removed are deleted, each once, even if listed
+     * more than once. The objects are deleted within a single WManager
+     * removal batch, so pending timers and updates are dropped in one sweep
+     * (see WManager::beginRemovalBatch()).
+     */
+    void removeAndDeleteSubObjects(const std::vector<GuiObject*>& objects);
+
     /**
      * Calls removeSubObject() with the given o and deletes it.
      *
@@ -315,10 +378,51 @@ public:
 
     void setMinSize(const Point& minSize);
 
+    const Point& getMinSize() const;
+
     void setMaxSize(const Point& maxSize);
 
+    const Point& getMaxSize() const;
+
+    /**
+     * Sets the layout that arranges this object's sub-objects, or removes it
+     * if layout is 0. This object takes ownership of the layout and deletes a
+     * previously set one.
+     */
+    void setLayout(Layout* layout);
+
+    Layout* getLayout() const;
+
+    /**
+     * Sets how much of its parent layout's spare space this object takes up,
+     * relative to its siblings. With a stretch of 0 (the default), the object
+     * keeps its size along the layout direction.
+     */
+    void setStretch(float stretch);
+
+    float getStretch() const;
+
+    /**
+     * Marks this object's layout dirty, so it is applied before the next frame
+     * is rendered (see Layout). Does nothing if no layout is set.
+     */
+    void invalidateLayout();
+
+    /**
+     * Applies this object's layout if it is dirty. This is called by WManager.
+     */
+    void updateLayout();
+
     void setResizeFrame(int top, int left, int bottom, int right);
 
+    /**
+     * Adds the memory used by this object, excluding its sub-objects, to f
+     * (see MemoryReport). Widgets that add members override this, call the
+     * base class implementation, set f.object to their own size and add the
+     * heap memory their members own.
+     */
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 protected:
 
     /**
@@ -338,6 +442,22 @@ private:
      */
     void resetSubObjContainsMouseStatus();
 
+    /**
+     * Gets whether o is held at its recorded index in subObjects_.
+     */
+    bool holdsSubObject(const GuiObject* o) const;
+
+    /**
+     * Updates the recorded indices of subObjects_[from] and all sub-objects
+     * behind it.
+     */
+    void updateSubObjIndices(unsigned int from);
+
+    /**
+     * Clears the parent-related state of a removed sub-object.
+     */
+    void detachSubObject(GuiObject* o);
+
     /**
      * Puts the given sub-object in the last position in subObjects_, moving all
      * sub-objects behind it closer to the front.
@@ -385,6 +505,10 @@ private:
 
     bool bIsClickThrough_;
 
+    bool bIsFocusable_;
+
+    bool bIsFocused_;
+
     /**
      * The area specifying where this GuiObject can be dragged to. If set to 0,
      * the parent frames the area.
@@ -414,6 +538,24 @@ private:
     Point minSize_;
 
     Point maxSize_;
+
+    /**
+     * Index of this object in the sub-object list of the object holding it
+     * (which is not necessarily parent_, see ClippingBox), or -1.
+     */
+    int subObjIndex_;
+
+    Layout* layout_;
+
+    float stretch_;
+
+    bool bLayoutDirty_;
+
+    /**
+     * Whether layout_ is being applied, during which resizing sub-objects
+     * must not mark the layout dirty again
+     */
+    bool bApplyingLayout_;
 };
 
 
@@ -80,6 +80,18 @@ enum KeyCode {
 };
 
 
+/**
+ * Modifier flags used for keyboard shortcuts. Flags can be combined with
+ * bitwise OR, e.g. (GW1K_MOD_CTRL | GW1K_MOD_SHIFT).
+ */
+enum KeyModifier {
+    GW1K_MOD_NONE = 0,
+    GW1K_MOD_SHIFT = 1,
+    GW1K_MOD_CTRL = 2,
+    GW1K_MOD_ALT = 4
+};
+
+
 enum TextProperty {
     GW1K_ALIGN_LEFT = 1,
     GW1K_ALIGN_CENTER = 2,
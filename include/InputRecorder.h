@@ -0,0 +1,134 @@
+#ifndef GW1K_INPUTRECORDER_H_
+#define GW1K_INPUTRECORDER_H_
+
+#include <fstream>
+
+namespace gw1k
+{
+
+
+/**
+ * An input event as received from GLFW (see GLFWApp's callbacks); key codes
+ * and mouse buttons are GLFW values.
+ */
+struct InputEvent
+{
+
+    enum Type
+    {
+        /** a, b: x, y */
+        MOUSE_MOVE,
+        /** a, b: button identifier, event */
+        MOUSE_BUTTON,
+        /** a: wheel position */
+        MOUSE_WHEEL,
+        /** a, b: key, event */
+        KEY,
+        /** a, b: width, height */
+        RESIZE,
+        /** A frame has been rendered after the preceding events */
+        FRAME
+    };
+
+    InputEvent(Type type = FRAME, double time = 0., int a = 0, int b = 0);
+
+    Type type;
+
+    /** Seconds since the recording started */
+    double time;
+
+    int a;
+
+    int b;
+
+};
+
+
+/**
+ * Writes input events to a file in a compact binary format: after a header,
+ * each event is stored as its type, the time since the previous event (in
+ * microseconds) and its parameters, all but the type as variable-length
+ * integers, so a typical event takes four to six bytes.
+ */
+class InputRecorder
+{
+
+public:
+
+    InputRecorder();
+
+    ~InputRecorder();
+
+public:
+
+    /**
+     * Creates the file and writes the header. Returns false if the file cannot
+     * be written.
+     */
+    bool open(const char* filename);
+
+    void close();
+
+    bool isOpen() const;
+
+    void record(const InputEvent& ev);
+
+private:
+
+    void writeNumber(unsigned long v);
+
+    void writeSigned(int v);
+
+private:
+
+    std::ofstream file_;
+
+    /** Time of the previous event, in whole microseconds */
+    double lastTime_;
+
+};
+
+
+/**
+ * Reads input events written by InputRecorder.
+ */
+class InputReplayer
+{
+
+public:
+
+    InputReplayer();
+
+public:
+
+    /**
+     * Opens the file and checks the header. Returns false if the file cannot be
+     * read or is not an input recording.
+     */
+    bool open(const char* filename);
+
+    /**
+     * Reads the next event into ev. Returns false at the end of the recording
+     * (or if it is corrupt).
+     */
+    bool next(InputEvent& ev);
+
+private:
+
+    bool readNumber(unsigned long& v);
+
+    bool readSigned(int& v);
+
+private:
+
+    std::ifstream file_;
+
+    /** Time of the previous event, in whole microseconds */
+    double lastTime_;
+
+};
+
+
+} // namespace gw1k
+
+#endif // GW1K_INPUTRECORDER_H_
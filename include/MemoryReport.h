@@ -0,0 +1,192 @@
+#ifndef GW1K_MEMORYREPORT_H_
+#define GW1K_MEMORYREPORT_H_
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace gw1k
+{
+
+
+class GuiObject;
+struct ColorTable;
+
+
+/**
+ * The memory used by a widget, by kind, as filled in by
+ * GuiObject::accountMemory(). Heap sizes are estimated from the sizes of the
+ * elements stored, so allocator overhead is not included.
+ */
+struct MemoryFootprint
+{
+
+    MemoryFootprint();
+
+    MemoryFootprint& operator+=(const MemoryFootprint& f);
+
+    /**
+     * Gets the bytes of main memory (all but gpu).
+     */
+    std::size_t getHostTotal() const;
+
+    /**
+     * Adds the colours allocated by the given ColorTable.
+     */
+    void addColors(const ColorTable& ct);
+
+    /** The object itself, i.e., the size of its most derived class */
+    std::size_t object;
+
+    /** Colours allocated by ColorTables */
+    std::size_t colors;
+
+    /** Listener lists and the sub-object list */
+    std::size_t listeners;
+
+    /**
+     * Strings and text layouts. Of an FTGL layout, only the layout object
+     * itself is counted: its implementation object and the line and glyph
+     * buffers it uses while laying out text are internal to FTGL and cannot
+     * be sized, so texts are somewhat under-reported.
+     */
+    std::size_t text;
+
+    /** Other heap buffers, e.g., sample data */
+    std::size_t buffers;
+
+    /** Textures and buffer objects */
+    std::size_t gpu;
+
+    /** Fonts referenced (fonts are shared, so they're not sized per widget) */
+    std::set<const void*> fonts;
+
+};
+
+
+template <typename T>
+std::size_t
+getHeapSize(const std::vector<T>& v)
+{
+    return v.capacity() * sizeof(T);
+}
+
+
+template <typename T>
+std::size_t
+getHeapSize(const std::list<T>& l)
+{
+    // Each node holds the element and two links
+    return l.size() * (sizeof(T) + 2 * sizeof(void*));
+}
+
+
+template <typename K, typename V, typename C, typename A>
+std::size_t
+getHeapSize(const std::map<K, V, C, A>& m)
+{
+    // Each tree node holds the element, three links and its colour
+    return m.size() * (sizeof(typename std::map<K, V, C, A>::value_type)
+        + 4 * sizeof(void*));
+}
+
+
+template <typename T, typename C, typename A>
+std::size_t
+getHeapSize(const std::multiset<T, C, A>& s)
+{
+    return s.size() * (sizeof(T) + 4 * sizeof(void*));
+}
+
+
+inline std::size_t
+getHeapSize(const std::string& s)
+{
+    // Strings up to the capacity of an empty string are stored inline (small
+    // string optimisation), so they have no heap buffer
+    static const std::size_t inlineCapacity = std::string().capacity();
+    return (s.capacity() > inlineCapacity) ? s.capacity() + 1 : 0;
+}
+
+
+/**
+ * Accumulates the memory footprints of widget trees per widget class.
+ *
+ * Sub-objects that are members of another widget (e.g., a Label's Text) are
+ * not counted as widgets of their own, but their memory is added to the
+ * widget containing them; all other sub-objects are counted for their own
+ * class.
+ */
+class MemoryReport
+{
+
+public:
+
+    struct Entry
+    {
+        Entry();
+
+        /** The number of widgets of the class */
+        unsigned int count;
+
+        /** The memory used by all widgets of the class */
+        MemoryFootprint footprint;
+    };
+
+public:
+
+    /**
+     * Adds o and its whole sub-tree to the report.
+     */
+    void add(const GuiObject* o);
+
+    void clear();
+
+    /**
+     * Gets the entries per widget class, with the (demangled) class names as
+     * keys.
+     */
+    const std::map<std::string, Entry>& getEntries() const;
+
+    /**
+     * Gets the sum of all entries.
+     */
+    Entry getTotal() const;
+
+    /**
+     * Logs the footprint of each widget class. If perWidgets is not 0, the
+     * footprint is given for that many widgets of each class (e.g., 1000) rather
+     * than for the widgets actually counted, which allows comparing footprints
+     * across builds independently of the widget tree used.
+     */
+    void log(unsigned int perWidgets = 0) const;
+
+    /**
+     * Gets the name of o's most derived class.
+     */
+    static std::string getClassName(const GuiObject* o);
+
+private:
+
+    /**
+     * Adds o's footprint to the entry of its class, or to owner if o is a
+     * member of the object at [ownerBegin, ownerEnd).
+     */
+    void add(const GuiObject* o,
+             Entry* owner,
+             const char* ownerBegin,
+             const char* ownerEnd);
+
+private:
+
+    std::map<std::string, Entry> entries_;
+
+};
+
+
+} // namespace gw1k
+
+#endif // GW1K_MEMORYREPORT_H_
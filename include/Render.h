@@ -33,13 +33,101 @@ void fillTriangle(const geom::Point2D& p0,
                   const geom::Point2D& p1,
                   const geom::Point2D& p2);
 
+/**
+ * Passed as sizeIdx to the ellipse functions to choose the number of segments
+ * from the ellipse's size on screen (assuming the projection maps to window
+ * pixels, as set up by GLFWApp), so the outline is off by at most a quarter
+ * pixel. The fixed sizes 0, 1 and 2 use 50, 200 and 1000 segments.
+ */
+const int ELLIPSE_ADAPTIVE = -1;
+
 void drawEllipse(const geom::Point2D& center,
                  const geom::Point2D& radius,
-                 int sizeIdx = 1);
+                 int sizeIdx = ELLIPSE_ADAPTIVE);
 
 void fillEllipse(const geom::Point2D& center,
                  const geom::Point2D& radius,
-                 int sizeIdx = 1);
+                 int sizeIdx = ELLIPSE_ADAPTIVE);
+
+/**
+ * Anti-aliased variant of drawEllipse(); requires blending to be enabled.
+ */
+void drawEllipseSmooth(const geom::Point2D& center,
+                       const geom::Point2D& radius,
+                       int sizeIdx = ELLIPSE_ADAPTIVE);
+
+/**
+ * Anti-aliased variant of fillEllipse(); requires blending to be enabled.
+ */
+void fillEllipseSmooth(const geom::Point2D& center,
+                       const geom::Point2D& radius,
+                       int sizeIdx = ELLIPSE_ADAPTIVE);
+
+/**
+ * Fills n ellipses (given by centers[i] and radii[i]) in a single draw call.
+ */
+void fillEllipses(const geom::Point2D* centers,
+                  const geom::Point2D* radii,
+                  int n,
+                  int sizeIdx = ELLIPSE_ADAPTIVE);
+
+/**
+ * Fills n axis-aligned rectangles in a single draw call; rectangle i spans
+ * from corners[2 * i] to corners[2 * i + 1].
+ */
+void fillRects(const geom::Point2D* corners, int n);
+
+/**
+ * Fills n triangles (three consecutive points each) in a single draw call.
+ */
+void fillTriangles(const geom::Point2D* points, int n);
+
+/**
+ * Appearance of a rectangle drawn by drawStyledRect(). Colours that are null
+ * are not drawn.
+ */
+struct BoxStyle
+{
+
+    /**
+     * Creates a style with square corners, a one pixel border, and no colours.
+     */
+    BoxStyle();
+
+    float cornerRadius;
+
+    /** Width of the border, which lies inside the rectangle */
+    float borderWidth;
+
+    const Color4i* fillColor;
+
+    /**
+     * If not null, the fill fades vertically from fillColor at the top to this
+     * colour at the bottom.
+     */
+    const Color4i* gradientColor;
+
+    const Color4i* borderColor;
+
+};
+
+/**
+ * Draws the rectangle from p0 to p1 (exclusive) with rounded corners, border
+ * and gradient fill as a single quad, evaluating the shape per pixel in a
+ * shader. Without shader support, corners are square and the border is one
+ * pixel wide.
+ */
+void drawStyledRect(const geom::Point2D& p0,
+                    const geom::Point2D& p1,
+                    const BoxStyle& style);
+
+/**
+ * Draws n styled rectangles in a single draw call; rectangle i spans from
+ * corners[2 * i] to corners[2 * i + 1] and uses styles[i].
+ */
+void drawStyledRects(const geom::Point2D* corners,
+                     const BoxStyle* styles,
+                     int n);
 
 void setGLColor(const Color4i* c);
 
@@ -0,0 +1,108 @@
+#ifndef GW1K_RENDERPIPELINE_H_
+#define GW1K_RENDERPIPELINE_H_
+
+#include "Color4i.h"
+
+#include <GL/glew.h>
+
+namespace gw1k
+{
+
+
+enum RenderPath
+{
+    /**
+     * Transforms go through OpenGL's matrix stack, and primitives are drawn
+     * with the fixed-function pipeline
+     */
+    GW1K_RENDER_FIXED_FUNCTION,
+
+    /**
+     * Transforms are computed on the CPU and passed to gw1k's own shaders as
+     * uniforms; primitives are streamed through a buffer object
+     */
+    GW1K_RENDER_SHADERS
+};
+
+
+/**
+ * Selects how gw1k renders; requires a GL context. The shader path needs
+ * OpenGL 2.0 (or OpenGL ES 2.0); if the shaders cannot be created, the fixed-
+ * function path stays selected and false is returned.
+ *
+ * The shader path only uses calls that are also available in core profiles for
+ * gw1k's primitives (see Render.h) and transforms. Content that still relies on
+ * the fixed-function pipeline, like FTGL text and OGLView::renderOGLContent(),
+ * is rendered after loading the current transform into OpenGL's matrix stack
+ * (see syncFixedFunctionTransform()), so a compatibility context is needed for
+ * it. Colours used by the primitives must be set with setGLColor().
+ */
+bool setRenderPath(RenderPath path);
+
+RenderPath getRenderPath();
+
+/**
+ * Sets an orthographic projection, like glOrtho() with near and far at -1 and
+ * 1.
+ */
+void setOrthoProjection(float left, float right, float bottom, float top);
+
+/**
+ * The following functions work on the modelview transform just like their
+ * OpenGL equivalents (glLoadIdentity(), glPushMatrix(), glPopMatrix(),
+ * glTranslatef(), and glScalef()).
+ */
+void loadIdentityTransform();
+
+void pushTransform();
+
+void popTransform();
+
+void translateTransform(float x, float y);
+
+void scaleTransform(float x, float y);
+
+/**
+ * Gets the modelview transform as column-major 4x4 matrix.
+ */
+void getModelviewMatrix(float* m);
+
+/**
+ * Gets the product of projection and modelview transform as column-major 4x4
+ * matrix.
+ */
+void getTransformMatrix(float* m);
+
+/**
+ * On the shader path, loads the current projection and modelview transform
+ * into OpenGL's matrix stack (if they changed since the last call), so fixed-
+ * function drawing appears in the same place as gw1k's primitives. Does
+ * nothing on the fixed-function path.
+ */
+void syncFixedFunctionTransform();
+
+/**
+ * Sets the colour used for drawVertices(); called by setGLColor().
+ */
+void setDrawColor(const Color4i& c);
+
+/**
+ * Draws n vertices (x, y pairs) with the given mode (which must not be one of
+ * the modes removed from core profiles, like GL_QUADS) in the colour set last.
+ */
+void drawVertices(GLenum mode, const float* xy, int n);
+
+/**
+ * Makes the given n floats available as vertex attribute data and returns the
+ * pointer to pass to glVertexAttribPointer(): on the shader path, the data is
+ * streamed into a buffer object and the result is an offset into it;
+ * otherwise, data itself is returned. Call releaseVertices() after drawing.
+ */
+const float* streamVertices(const float* data, int n);
+
+void releaseVertices();
+
+
+} // namespace gw1k
+
+#endif // GW1K_RENDERPIPELINE_H_
@@ -56,11 +56,15 @@ public:
 
     virtual void setColors(const char* colorScheme);
 
+    const ColorTable& getColorTable() const;
+
     /**
      * Calls queryColors() with the current state of this Renderable.
      */
     void selectColors(Color4i*& fg, Color4i*& bg) const;
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 protected:
 
     /**
@@ -63,6 +63,25 @@ public:
     const Color4i* getClickedBgColor(const char* colorScheme,
                                      const char* fallbackScheme) const;
 
+    /**
+     * Gets the style property (e.g., "radius") set for the given scheme, or
+     * defaultValue if the theme doesn't set it.
+     */
+    float getStyleValue(const char* property,
+                        const char* colorScheme,
+                        const char* fallbackScheme,
+                        float defaultValue) const;
+
+    /**
+     * Suspends or resumes theme lookups. While suspended, the setColors()
+     * methods taking scheme names leave colours unchanged, and getStyleValue()
+     * returns the default value. This is used when colours are restored in bulk
+     * (see WidgetSnapshot).
+     */
+    void setLookupsSuspended(bool state = true);
+
+    bool areLookupsSuspended() const;
+
 private:
 
     const Color4i* getColor(const char* modespec,
@@ -81,7 +100,11 @@ private:
 
     std::map<std::string, Color4i*> colorMap_;
 
+    std::map<std::string, float> styleMap_;
+
     lua_State* l_;
+
+    bool bLookupsSuspended_;
 };
 
 
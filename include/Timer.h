@@ -36,6 +36,21 @@ public:
 
     bool operator>=(const timeval& time) const;
 
+    /**
+     * Gets the current time, which is the system time unless a virtual time is
+     * set.
+     */
+    static void getTime(timeval& now);
+
+    /**
+     * Makes timers use the given time (in seconds) as current time instead of
+     * the system time, until clearVirtualTime() is called. This allows running
+     * timers deterministically, e.g., when replaying recorded input.
+     */
+    static void setVirtualTime(double seconds);
+
+    static void clearVirtualTime();
+
 public:
 
     TimerListener* const target;
@@ -46,6 +61,10 @@ private:
 
     timeval tvEnd_;
 
+    static bool bVirtualTime_;
+
+    static timeval virtualTime_;
+
 };
 
 
@@ -6,9 +6,12 @@
 #include "Point.h"
 #include "WindowStack.h"
 #include "Timer.h"
+#include "CommandQueue.h"
 #include "listeners/TimerListener.h"
+#include "listeners/KeyListener.h"
 
 #include <list>
+#include <vector>
 
 namespace gw1k
 {
@@ -46,6 +49,16 @@ public:
 
     void feedKey(int key, StateEvent ev);
 
+    /**
+     * Sets the window size. Until the first frame has been rendered, the main
+     * window is resized right away, so widgets created before (e.g., in
+     * GLFWApp::preMainLoop()) can be sized relative to it. Afterwards,
+     * getWindowSize() returns the new size right away, but the main window
+     * (and thus the widget tree) is only resized at the beginning of the next
+     * render() call, before layouts are applied. When the size changes several
+     * times per frame (e.g., while the user drags the window's edge), only the
+     * last size is propagated.
+     */
     void setWindowSize(int width, int height);
 
     const Point& getWindowSize() const;
@@ -64,6 +77,15 @@ public:
 
     void popGlScissorOffset();
 
+    const Point& getGlScissorOffset() const;
+
+    /**
+     * See WindowStack::pushGlScissorOrigin().
+     */
+    void pushGlScissorOrigin(const Point& origin);
+
+    void popGlScissorOrigin();
+
     void render();
 
     /**
@@ -87,6 +109,19 @@ public:
      */
     void registerForPreRenderUpdate(GuiObject* o);
 
+    /**
+     * Queues the given object's layout to be applied before rendering the next
+     * frame. This is called by GuiObject::invalidateLayout(), which should be
+     * used instead.
+     */
+    void scheduleLayout(GuiObject* o);
+
+    /**
+     * Sets the layout of the main window, which covers the whole window and
+     * contains all objects added via addObject(). See GuiObject::setLayout().
+     */
+    void setLayout(Layout* layout);
+
     /**
      * Marks the given object for deletion before rendering the next frame.
      * This method should be used when GuiObjects need to be removed and deleted
@@ -106,10 +141,94 @@ public:
      *
      * The given object argument is checked for matches with any internally
      * referenced objects (hovered and clicked), and references are dropped
-     * accordingly in order to prevent any operation on the object.
+     * accordingly in order to prevent any operation on the object. Pending
+     * preRenderUpdate() calls, timers and posted commands targeting the object
+     * are dropped as well.
      */
     void indicateRemovedObject(const GuiObject* o);
 
+    /**
+     * Starts a removal batch. Until the matching endRemovalBatch() call,
+     * indicateRemovedObject() only drops the hovered, clicked and focused
+     * references and records the object; pending timers, preRenderUpdate()
+     * calls, layout updates and posted commands of all recorded objects are
+     * then dropped in a single sweep by endRemovalBatch(). This makes tearing
+     * down large subtrees linear in the number of removed objects. Batches may be nested; only the
+     * outermost endRemovalBatch() performs the sweep.
+     */
+    void beginRemovalBatch();
+
+    void endRemovalBatch();
+
+    /**
+     * Gives the keyboard focus to the given object, which must be focusable
+     * (see GuiObject::setFocusable()). Passing 0 clears the focus.
+     *
+     * Key events fed via feedKey() are delivered to the focused object first,
+     * then to its embedded parents and its first non-embedded parent (just
+     * like mouse events). Clicking an object moves the focus to the object or,
+     * if it isn't focusable, to its closest focusable parent.
+     */
+    void setFocus(GuiObject* o);
+
+    GuiObject* getFocusedObject() const;
+
+    /**
+     * Moves the focus to the next focusable object in tab order, which is the
+     * order in which objects are rendered. Wraps around after the last one.
+     */
+    void focusNext();
+
+    /**
+     * Moves the focus to the previous focusable object in tab order.
+     */
+    void focusPrevious();
+
+    /**
+     * Sets whether pressing Tab (or Shift+Tab) moves the focus via focusNext()
+     * (or focusPrevious()). Enabled by default. If disabled, Tab is delivered
+     * to the focused object like any other key.
+     */
+    void setTabFocusTraversal(bool state = true);
+
+    /**
+     * Registers a global keyboard shortcut. When key is pressed while exactly
+     * the given modifiers (a combination of KeyModifier flags) are held down,
+     * the listener's keyEvent() is called with the currently focused object
+     * (possibly 0) as receiver, and the key event is not delivered to the
+     * focused object. Shortcuts are only triggered on key press.
+     *
+     * A previously registered shortcut for the same combination is replaced.
+     * Lookup takes constant time regardless of the number of shortcuts.
+     */
+    void addShortcut(int key, int modifiers, KeyListener* l);
+
+    void removeShortcut(int key, int modifiers);
+
+    /**
+     * Gets the KeyModifier flags of the modifier keys currently held down.
+     */
+    int getKeyModifiers() const;
+
+    /**
+     * Posts a command to be executed on the GUI thread at the beginning of the
+     * next render() call, before deleting objects marked for deletion and
+     * before the preRenderUpdate() calls. This is the only WManager method
+     * that may be called from threads other than the GUI thread (given that
+     * the WManager instance already exists). The WManager takes ownership of
+     * c. Returns false if the command queue is full; see CommandQueue.
+     *
+     * Pending commands whose target is a GuiObject (as for commands created by
+     * makeCommand()) are dropped when the object is deleted. Other threads must
+     * therefore not post commands for an object once it may have been deleted,
+     * e.g., they should be stopped before the object is removed.
+     *
+     * Example: postCommand(makeCommand(slider, &Slider::setValue, v));
+     */
+    bool postCommand(Command* c);
+
+    CommandQueue& getCommandQueue();
+
     void addTimer(double seconds, TimerListener* target, int token);
 
     void removeTimers(TimerListener* target);
@@ -125,15 +244,44 @@ private:
     void feedMouseMoveInternal_handleClickedObj(const Point& pos,
                                                 const Point& delta);
 
+    /**
+     * Makes o the hovered object. Only the objects on the differing parts of
+     * the old and new hover paths are informed about the mouse leaving or
+     * entering them; the objects on the common part receive hover events (see
+     * hoverPath_).
+     */
+    void updateHoverPath(GuiObject* o, const Point& pos, const Point& delta);
 
-    void feedMouseMoveHandleOldHoveredObj(const Point& pos,
-                                          const Point& delta,
-                                          const GuiObject* newHoveredObj) const;
+    void checkTimers();
 
-    void feedMouseMoveHandleNewHoveredObj(const Point& pos,
-                                          const Point& delta) const;
+    /**
+     * Applies all dirty layouts, outermost containers first.
+     */
+    void updateLayouts();
 
-    void checkTimers();
+    void moveFocus(int step);
+
+    void updateFocusOnClick(GuiObject* clickedObj);
+
+    void updateModifierKeys(int key, StateEvent ev);
+
+    /**
+     * Gets the index into shortcuts_ for the given key and modifiers, or -1 if
+     * the key cannot be used as a shortcut.
+     */
+    int getShortcutIndex(int key, int modifiers) const;
+
+    /**
+     * Removes and deletes the objects marked for deletion, deepest objects
+     * first, so that queued descendants are deleted before their ancestors.
+     */
+    void processDeleteQueue();
+
+    /**
+     * Drops pending timers, preRenderUpdate() calls and layout updates of the
+     * objects recorded during the current removal batch.
+     */
+    void dropRemovedObjects();
 
 private:
 
@@ -142,6 +290,17 @@ private:
     /** GUI element hovered by mouse the last time feedMouseMove() was called */
     GuiObject* hoveredObj_;
 
+    /**
+     * The objects that receive the hovered object's mouse moved events: the
+     * first non-embedded parent of hoveredObj_, its embedded sub-objects down
+     * to hoveredObj_, and hoveredObj_ itself (last). If hoveredObj_ is not
+     * embedded, this is just hoveredObj_.
+     */
+    std::vector<GuiObject*> hoverPath_;
+
+    /** Reused by updateHoverPath() */
+    std::vector<GuiObject*> newHoverPath_;
+
     /** GUI element that has been clicked and not released yet */
     GuiObject* clickedObj_;
 
@@ -149,6 +308,12 @@ private:
 
     Point winSize_;
 
+    /** Whether mainWin_ still needs to be resized to winSize_ */
+    bool bWindowResizePending_;
+
+    /** Whether render() has been called, after which resizes are coalesced */
+    bool bFrameRendered_;
+
     WindowStack scissorStack_;
 
     Point mousePos_;
@@ -157,12 +322,43 @@ private:
 
     std::list<GuiObject*> preRenderUpdateQueue_;
 
-    std::list<GuiObject*> preRenderDeleteQueue_;
+    std::vector<GuiObject*> preRenderDeleteQueue_;
+
+    /** Objects whose layout needs to be applied before the next frame */
+    std::vector<GuiObject*> layoutQueue_;
 
     std::list<Timer*> timerList_;
 
+    CommandQueue commandQueue_;
+
     MouseButton lastMouseButton_;
 
+    /** GUI element that currently has the keyboard focus */
+    GuiObject* focusedObj_;
+
+    bool bTabFocusTraversal_;
+
+    /** Bit field of the modifier keys (left and right) currently pressed */
+    int pressedModifierKeys_;
+
+    /**
+     * Shortcut listeners, indexed by key code and modifier combination (see
+     * getShortcutIndex()). Unused entries are 0.
+     */
+    std::vector<KeyListener*> shortcuts_;
+
+    /** Nesting depth of removal batches, see beginRemovalBatch() */
+    int removalBatchDepth_;
+
+    /** Objects removed during the current removal batch */
+    std::vector<const GuiObject*> removedObjects_;
+
+    /**
+     * Whether the hovered object was removed during the current removal batch,
+     * so the hovered object needs to be determined anew after the batch
+     */
+    bool bHoverLost_;
+
 };
 
 } // namespace gw1k
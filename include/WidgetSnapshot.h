@@ -0,0 +1,56 @@
+#ifndef GW1K_WIDGETSNAPSHOT_H_
+#define GW1K_WIDGETSNAPSHOT_H_
+
+#include <vector>
+
+namespace gw1k
+{
+
+
+class GuiObject;
+
+
+/**
+ * Saves a widget tree to a binary snapshot file and creates widget trees from
+ * such files, which is much faster than setting up a large UI in code: all
+ * colours, styles and text measurements are stored in the snapshot, so loading
+ * neither looks up the theme nor measures texts, and fonts are looked up once
+ * per font rather than once per widget.
+ *
+ * A snapshot stores the widgets' types, positions, sizes and flags (visible,
+ * interactive, etc.), their colours (as indices into a table of the distinct
+ * colour tables used), and for Labels text, alignment, padding, font (as index
+ * into a table of the fonts used) and the text measurements.
+ *
+ * Supported widget types are Box, WiBox and Label; widgets of any other type
+ * (including classes derived from those) are skipped, along with their
+ * sub-objects, with a warning. Listeners, layouts and timers are not saved.
+ *
+ * Snapshots are only valid for the theme, the font files and the gw1k version
+ * they were written with, and for machines of the same byte order, since they
+ * are loaded directly from a memory-mapped file.
+ */
+class WidgetSnapshot
+{
+
+public:
+
+    /**
+     * Writes o and its sub-tree to the given file. Returns false if the file
+     * cannot be written.
+     */
+    static bool write(const GuiObject* o, const char* filename);
+
+    /**
+     * Creates the widget tree stored in the given file and returns its root,
+     * which is owned by the caller, or 0 if the file cannot be read or is not a
+     * valid snapshot.
+     */
+    static GuiObject* load(const char* filename);
+
+};
+
+
+} // namespace gw1k
+
+#endif // GW1K_WIDGETSNAPSHOT_H_
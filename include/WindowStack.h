@@ -25,6 +25,18 @@ public:
 
     void popGlScissorOffset();
 
+    const Point& getGlScissorOffset() const;
+
+    /**
+     * Sets the window pixel (in glScissor() coordinates) that the current
+     * framebuffer's origin corresponds to, e.g. when rendering a part of the
+     * window into an offscreen buffer, and re-applies the current scissor
+     * window accordingly.
+     */
+    void pushGlScissorOrigin(const Point& origin);
+
+    void popGlScissorOrigin();
+
 private:
 
     void setGlScissors(const int* i4) const;
@@ -41,6 +53,10 @@ private:
 
     Point offset_;
 
+    std::vector<Point> originStack_;
+
+    Point origin_;
+
 };
 
 } // namespace gw1k
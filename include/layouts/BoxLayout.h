@@ -0,0 +1,45 @@
+#ifndef GW1K_BOXLAYOUT_H_
+#define GW1K_BOXLAYOUT_H_
+
+#include "Layout.h"
+
+namespace gw1k
+{
+
+
+/**
+ * BoxLayout arranges sub-objects in a row (horizontal) or column (vertical),
+ * in the order they were added.
+ *
+ * Along the layout direction, sub-objects with a stretch factor of 0 (see
+ * GuiObject::setStretch()) keep their size, and the remaining space is divided
+ * among the others in proportion to their stretch factors. Across it,
+ * sub-objects fill the container, up to their maximum size.
+ */
+class BoxLayout : public Layout
+{
+
+public:
+
+    enum Direction { HORIZONTAL, VERTICAL };
+
+    BoxLayout(Direction direction, int spacing = 0, int padding = 0);
+
+    virtual ~BoxLayout();
+
+public:
+
+    Direction getDirection() const;
+
+    virtual void apply(GuiObject* container);
+
+private:
+
+    Direction direction_;
+
+};
+
+
+} // namespace gw1k
+
+#endif // GW1K_BOXLAYOUT_H_
@@ -0,0 +1,65 @@
+#ifndef GW1K_GRIDLAYOUT_H_
+#define GW1K_GRIDLAYOUT_H_
+
+#include "Layout.h"
+
+#include <vector>
+
+namespace gw1k
+{
+
+
+/**
+ * GridLayout arranges sub-objects in a grid with a fixed number of columns,
+ * filling rows from left to right in the order the sub-objects were added.
+ *
+ * A column is as wide as the largest minimum width of its sub-objects at least,
+ * and as the smallest maximum width at most (likewise for rows). Space is
+ * divided among columns and rows in proportion to their stretch factors, which
+ * are 1 by default. Sub-objects fill their cell, up to their maximum size.
+ */
+class GridLayout : public Layout
+{
+
+public:
+
+    GridLayout(int columns, int spacing = 0, int padding = 0);
+
+    virtual ~GridLayout();
+
+public:
+
+    int getColumns() const;
+
+    /**
+     * Sets the stretch factor of the given column; 0 keeps it at its minimum
+     * width.
+     */
+    void setColumnStretch(int column, float stretch);
+
+    /**
+     * Sets the stretch factor of the given row; 0 keeps it at its minimum
+     * height.
+     */
+    void setRowStretch(int row, float stretch);
+
+    virtual void apply(GuiObject* container);
+
+private:
+
+    float getStretch(const std::vector<float>& stretch, int i) const;
+
+private:
+
+    int columns_;
+
+    std::vector<float> columnStretch_;
+
+    std::vector<float> rowStretch_;
+
+};
+
+
+} // namespace gw1k
+
+#endif // GW1K_GRIDLAYOUT_H_
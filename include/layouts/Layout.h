@@ -0,0 +1,124 @@
+#ifndef GW1K_LAYOUT_H_
+#define GW1K_LAYOUT_H_
+
+#include <vector>
+
+namespace gw1k
+{
+
+
+class GuiObject;
+
+
+/**
+ * A Layout positions and sizes the visible sub-objects of the GuiObject it is
+ * set on (see GuiObject::setLayout()), honouring their minimum and maximum
+ * sizes and stretch factors.
+ *
+ * Layouts are not applied immediately. Changing the container's size or
+ * sub-objects, a sub-object's minimum or maximum size, stretch, or visibility,
+ * or the layout's settings marks the container's layout dirty. So does
+ * resizing a sub-object other than by the layout itself (e.g., an auto-sized
+ * Label growing with its text), since layouts keep the size of sub-objects
+ * without stretch. WManager applies all dirty layouts once before rendering
+ * the next frame, outermost containers first. Containers resized by their
+ * parent's layout are laid out in the same pass, so only dirty sub-trees are
+ * visited.
+ */
+class Layout
+{
+
+    friend class GuiObject;
+
+public:
+
+    Layout();
+
+    virtual ~Layout();
+
+public:
+
+    /**
+     * Sets the gap between the container's border and its sub-objects.
+     */
+    void setPadding(int padding);
+
+    int getPadding() const;
+
+    /**
+     * Sets the gap between adjacent sub-objects.
+     */
+    void setSpacing(int spacing);
+
+    int getSpacing() const;
+
+    /**
+     * Positions and sizes the visible sub-objects of container.
+     */
+    virtual void apply(GuiObject* container) = 0;
+
+protected:
+
+    /**
+     * Extent of an item along one axis, for distribute().
+     */
+    struct Span
+    {
+        Span(float min, float max, float stretch, float size);
+
+        float min;
+
+        float max;
+
+        float stretch;
+
+        /** Size of an item without stretch; the resulting size after distribute() */
+        float size;
+    };
+
+    /**
+     * Marks the layout of the container dirty.
+     */
+    void invalidate();
+
+    /**
+     * Gets the visible sub-objects of container.
+     */
+    static void getItems(const GuiObject* container,
+                         std::vector<GuiObject*>& items);
+
+    /**
+     * Sets the sizes of spans with a stretch factor greater than 0 such that
+     * all spans fill available, dividing the space in proportion to the
+     * stretch factors but keeping to minimum and maximum sizes. Spans without
+     * stretch keep their size (clamped to minimum and maximum).
+     */
+    static void distribute(std::vector<Span>& spans, float available);
+
+    /**
+     * Gets the integer positions of consecutive spans starting at start with
+     * spacing in between; span i covers [pos[i], pos[i + 1] - spacing).
+     * Positions are rounded cumulatively, so there are no gaps from rounding.
+     */
+    static void getPositions(const std::vector<Span>& spans,
+                             int start,
+                             int spacing,
+                             std::vector<int>& pos);
+
+protected:
+
+    int padding_;
+
+    int spacing_;
+
+private:
+
+    /** The GuiObject this layout is set on */
+    GuiObject* container_;
+
+};
+
+
+} // namespace gw1k
+
+#endif // GW1K_LAYOUT_H_
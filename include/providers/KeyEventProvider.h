@@ -27,6 +27,10 @@ public:
 
     void removeKeyListener(KeyListener* kl);
 
+protected:
+
+    void informKeyListeners(int key, StateEvent ev, GuiObject* receiver);
+
 protected:
 
     std::list<KeyListener*> keyListeners_;
@@ -23,7 +23,14 @@ public:
 
 public:
 
-    void addMouseListener(MouseListener* ml);
+    /**
+     * Adds a mouse listener. GW1K_M_HOVERED events for mouse moves over the
+     * object (that is, while no button is held down) are only delivered if
+     * bHoverEvents is set; otherwise, the listener only learns about the mouse
+     * entering and leaving. While the object is clicked, all mouse moves are
+     * delivered as GW1K_M_HOVERED events regardless of bHoverEvents.
+     */
+    void addMouseListener(MouseListener* ml, bool bHoverEvents = false);
 
     void removeMouseListener(MouseListener* ml);
 
@@ -34,6 +41,14 @@ protected:
                                    const Point& delta,
                                    GuiObject* receiver);
 
+    /**
+     * Informs the listeners that opted in to hover events (see
+     * addMouseListener()) about a GW1K_M_HOVERED event.
+     */
+    void informMouseListenersHovered(const Point& pos,
+                                     const Point& delta,
+                                     GuiObject* receiver);
+
     void informMouseListenersClicked(MouseButton b,
                                      StateEvent ev,
                                      GuiObject* receiver);
@@ -44,6 +59,9 @@ protected:
 
     std::list<MouseListener*> mouseListeners_;
 
+    /** The listeners of mouseListeners_ that receive hover events */
+    std::list<MouseListener*> hoverListeners_;
+
 };
 
 
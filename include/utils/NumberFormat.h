@@ -0,0 +1,50 @@
+#ifndef GW1K_NUMBERFORMAT_H_
+#define GW1K_NUMBERFORMAT_H_
+
+namespace gw1k
+{
+
+
+/**
+ * The buffer size required by formatInt() and formatFixed(), including the
+ * terminating null character. This is enough for any double value printed
+ * with the maximum precision.
+ */
+const int NUMBER_FORMAT_BUFSIZE = 352;
+
+
+/**
+ * The maximum number of decimal places used by formatFixed(), which keeps the
+ * scaled fraction well within the integers a double represents exactly.
+ */
+const int NUMBER_FORMAT_MAX_PRECISION = 12;
+
+
+/**
+ * Writes the decimal representation of value to buf, which must provide at
+ * least NUMBER_FORMAT_BUFSIZE characters, and appends a null character.
+ * Returns the number of characters written (without the null character).
+ *
+ * Unlike toString(), this neither allocates memory nor involves any locale
+ * handling.
+ */
+int formatInt(long value, char* buf);
+
+
+/**
+ * Writes value in fixed-point notation with the given number of decimal places
+ * to buf, which must provide at least NUMBER_FORMAT_BUFSIZE characters, and
+ * appends a null character. Returns the number of characters written (without
+ * the null character).
+ *
+ * The result is the same as that of toString(value, precision), including
+ * the sign of -0 and of negative values that round to zero, except that
+ * precision is clamped to [0, NUMBER_FORMAT_MAX_PRECISION]. No memory is
+ * allocated, and no locale handling is involved.
+ */
+int formatFixed(double value, int precision, char* buf);
+
+
+} // namespace gw1k
+
+#endif // GW1K_NUMBERFORMAT_H_
@@ -0,0 +1,23 @@
+#ifndef GW1K_SHADERHELPERS_H_
+#define GW1K_SHADERHELPERS_H_
+
+#include <GL/glew.h>
+
+namespace gw1k
+{
+
+
+/**
+ * Compiles the given vertex and fragment shader sources and links them into a
+ * program. Returns the program, or 0 if shaders are not supported or
+ * compilation or linking failed (in which case the info log is written to the
+ * log, using who as sender).
+ */
+GLuint createShaderProgram(const char* vertexSrc,
+                           const char* fragmentSrc,
+                           const char* who);
+
+
+} // namespace gw1k
+
+#endif // GW1K_SHADERHELPERS_H_
@@ -26,6 +26,8 @@ public:
 
     virtual void renderBg(const Point& offset) const;
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 };
 
 
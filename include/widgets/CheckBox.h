@@ -47,6 +47,8 @@ public:
                               StateEvent ev,
                               GuiObject* receiver);
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 private:
 
     bool checked_;
@@ -5,6 +5,11 @@
 
 #include "ScrollPane.h"
 
+#include <GL/glew.h>
+
+#include <map>
+#include <set>
+
 namespace gw1k
 {
 
@@ -21,6 +26,17 @@ namespace gw1k
  * Sub-objects added to ClippingBox will get assigned as their parent the parent
  * of the ClippingBox. This is because ClippingBox is intended to serve as a
  * hidden container for ScrollBox.
+ *
+ * The extent of the sub-objects is tracked incrementally in ordered sets of
+ * their edges, so adding, removing, and updating a sub-object takes
+ * logarithmic time. Since sub-objects don't know about the ClippingBox, moving
+ * or resizing one must be reported via updateSubObjectBounds().
+ *
+ * With scroll caching enabled (see setScrollCaching()), the visible content is
+ * kept in an offscreen texture. When only the clipping offset has changed since
+ * the last frame, the texture is shifted by the scroll distance and only the
+ * newly exposed strips are rendered, so scrolling costs time proportional to
+ * the exposed area rather than to the whole content.
  */
 class ClippingBox : public Box
 {
@@ -69,10 +85,28 @@ public:
 
     virtual void removeSubObject(GuiObject* o);
 
+    /**
+     * Removes the given sub-objects, updating the bounds only once.
+     */
+    virtual void removeSubObjects(const std::vector<GuiObject*>& objects);
+
+    virtual void removeAndDeleteAllSubObjects();
+
     virtual GuiObject* getContainingObject(const Point& p);
 
     virtual bool containsMouse(const Point& p) const;
 
+    /**
+     * Updates real size and origin after the given sub-object has been moved
+     * or resized. Objects that are not sub-objects are ignored with a warning.
+     */
+    void updateSubObjectBounds(GuiObject* o);
+
+    /**
+     * Updates real size and origin from the bounds of all sub-objects. Use this
+     * after moving or resizing many sub-objects; for single ones,
+     * updateSubObjectBounds() is faster.
+     */
     void recalculateBounds();
 
     /** Do not return a reference here because the returned point will most likely
@@ -81,6 +115,26 @@ public:
 
     ScrollPane::AutoAdjustSize getAutoAdjustSize() const;
 
+    /**
+     * Enables or disables scroll caching. The cache is only refreshed where
+     * scrolling exposes content, after sub-objects are added, removed, or
+     * updated, and when the ClippingBox moves or is resized; if sub-objects
+     * change their appearance in other ways (e.g., when hovered), call
+     * invalidateScrollCache(). Content hidden by parents' clipping is not
+     * cached. Requires framebuffer object support; without it, content is
+     * rendered as usual.
+     */
+    void setScrollCaching(bool enabled);
+
+    bool isScrollCaching() const;
+
+    /**
+     * Makes the next frame render all visible content into the scroll cache.
+     */
+    void invalidateScrollCache();
+
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 private:
 
     /** Sets subObjAccommodationStatus. */
@@ -95,8 +149,55 @@ private:
      */
     void autoAdjustSubObj(GuiObject* o);
 
+    /**
+     * Records the edges of o in the edge sets.
+     */
+    void insertEdges(GuiObject* o);
+
+    /**
+     * Removes the recorded edges of o from the edge sets. Returns false if no
+     * edges were recorded for o, i.e., it is not a sub-object.
+     */
+    bool eraseEdges(const GuiObject* o);
+
+    /**
+     * Sets real origin and size to the recorded extent of the sub-objects (but
+     * not less than the "window"), keeping the window at its position.
+     */
+    void updateRealBounds();
+
+    /**
+     * Renders the sub-objects through the scroll cache. Returns false if the
+     * cache cannot be used.
+     */
+    bool renderCached(const Point& offset) const;
+
+    /**
+     * Renders the sub-objects that intersect the given strip of the "window"
+     * (relative to its top-left), clipped to the strip.
+     */
+    void renderStrip(const Point& offset,
+                     const Point& stripPos,
+                     const Point& stripSize) const;
+
+    /**
+     * Draws the cache texture source, shifted by -delta, into the currently
+     * bound framebuffer.
+     */
+    void shiftCache(int source, const Point& delta) const;
+
+    /**
+     * (Re)creates the cache textures and framebuffers if the size has changed.
+     * Returns false if the cache cannot be used.
+     */
+    bool createCache() const;
+
+    void deleteCache();
+
 private:
 
+    typedef std::multiset<int> EdgeSet;
+
     /**
      * This point determines the offset relative to realOrigin_ at which the
      * "window" starts through which one "sees" the pane content.
@@ -129,6 +230,39 @@ private:
     Point subObjAccommodationStatus_;
 
     ScrollPane::AutoAdjustSize autoAdjustSize_;
+
+    /** Bounds of each sub-object as recorded in the edge sets */
+    std::map<const GuiObject*, Rect> subObjBounds_;
+
+    /** Left, top, right, and bottom (end) edges of all sub-objects */
+    EdgeSet left_;
+
+    EdgeSet top_;
+
+    EdgeSet right_;
+
+    EdgeSet bottom_;
+
+    bool bScrollCaching_;
+
+    mutable bool bCacheUnsupported_;
+
+    mutable bool bCacheValid_;
+
+    /** Two cache textures, alternately used as source and target of shifts */
+    mutable GLuint cacheTex_[2];
+
+    mutable GLuint cacheFbos_[2];
+
+    mutable int currentCache_;
+
+    mutable Point cacheSize_;
+
+    /** Window position of the ClippingBox when the cache was last updated */
+    mutable Point cachedWinPos_;
+
+    /** realOrigin_ + clippingOffset_ when the cache was last updated */
+    mutable Point cachedView_;
 };
 
 
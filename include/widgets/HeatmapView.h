@@ -0,0 +1,149 @@
+#ifndef GW1K_HEATMAPVIEW_H_
+#define GW1K_HEATMAPVIEW_H_
+
+#include "OGLView.h"
+
+#include <GL/glew.h>
+
+#include <vector>
+
+namespace gw1k
+{
+
+
+/**
+ * HeatmapView displays a grid of values (e.g., a spectrogram) through a colour
+ * map. Like TextureView, it renders a texture, but the texture is allocated
+ * once and then updated in place, row by row or by sub-rectangles.
+ *
+ * Rows are kept in a ring: appendRow() overwrites the oldest row and moves the
+ * texture coordinates, so the rows appear scrolled by one without any copying.
+ * Logical row 0 (the oldest row) is displayed at the top.
+ *
+ * Values are mapped to [0,1] by the value range and quantised to 256 levels.
+ * If shaders are supported, the colour map is applied on the GPU through a 1D
+ * texture, so changing it doesn't require re-uploading values; otherwise,
+ * coloured texels are uploaded. Updates can optionally be streamed through a
+ * pair of pixel buffer objects (see setUsePixelBuffers()).
+ *
+ * The shade colours (see OGLView) are multiplied with the colour map.
+ */
+class HeatmapView : public OGLView
+{
+
+public:
+
+    HeatmapView(const Point& pos,
+                const Point& size,
+                int columns,
+                int rows,
+                const char* shadeColorScheme = 0);
+
+    virtual ~HeatmapView();
+
+public:
+
+    int getColumns() const;
+
+    int getRows() const;
+
+    /**
+     * Sets the values that are mapped to the first and last colour of the
+     * colour map; values outside are clamped. The default is [0,1]. Only
+     * affects values set afterwards.
+     */
+    void setValueRange(float min, float max);
+
+    /**
+     * Sets the colour map from the given colours, which are spread evenly over
+     * the value range and interpolated in between. The default is a black, blue,
+     * red, yellow, white heat scale.
+     */
+    void setColorMap(const std::vector<Color4i>& colors);
+
+    /**
+     * Overwrites the oldest row with values (getColumns() floats) and scrolls,
+     * making it the newest row.
+     */
+    void appendRow(const float* values);
+
+    /**
+     * Sets the values of the w x h rectangle at (x, y), where y is a logical
+     * row (0 is the oldest). values holds h rows of w floats each.
+     */
+    void setValues(int x, int y, int w, int h, const float* values);
+
+    /**
+     * Enables uploading through two alternating pixel buffer objects, so the
+     * driver can copy to the texture asynchronously. Has no effect if pixel
+     * buffer objects are not supported.
+     */
+    void setUsePixelBuffers(bool enabled);
+
+    virtual void renderOGLContent() const;
+
+    virtual void accountMemory(MemoryFootprint& f) const;
+
+private:
+
+    /**
+     * Creates the textures (and shader program) on first use, since a GL
+     * context is required.
+     */
+    void createTextures() const;
+
+    void uploadColorMap() const;
+
+    /**
+     * Uploads the texture rows [row, row + h) and columns [x, x + w) from
+     * values_.
+     */
+    void uploadRect(int x, int row, int w, int h) const;
+
+    /**
+     * Gets the texture row of logical row y.
+     */
+    int textureRow(int y) const;
+
+private:
+
+    int columns_;
+
+    int rows_;
+
+    /** Texture row of the oldest row */
+    int head_;
+
+    float minValue_;
+
+    float valueScale_;
+
+    /** Quantised values in texture row order */
+    std::vector<unsigned char> values_;
+
+    /** The colour map, sampled at 256 positions (RGBA) */
+    std::vector<unsigned char> colorMap_;
+
+    bool bUsePixelBuffers_;
+
+    mutable bool bTexturesCreated_;
+
+    mutable GLuint valueTex_;
+
+    mutable GLuint colorMapTex_;
+
+    mutable GLuint program_;
+
+    mutable GLuint pbos_[2];
+
+    mutable int nextPbo_;
+
+    /** Reused for converting rows for upload */
+    mutable std::vector<unsigned char> uploadBuf_;
+
+};
+
+
+} // namespace gw1k
+
+#endif // GW1K_HEATMAPVIEW_H_
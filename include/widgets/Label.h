@@ -45,10 +45,33 @@ public:
      */
     void setWrapText(bool wrap = true);
 
+    /**
+     * Sets the text. If latched updates are enabled, the text is only stored
+     * and laid out right before the next frame is rendered.
+     */
     virtual void setText(const std::string& text);
 
+    /**
+     * Gets the text most recently set, even if it has not been laid out yet.
+     */
     const std::string& getText() const;
 
+    /**
+     * Enables or disables latched updates. With latched updates, changes to
+     * the displayed text are stored immediately, but text layout and
+     * auto-sizing are deferred to a single pre-render pass (see
+     * WManager::registerForPreRenderUpdate()), so only the last text set per
+     * frame is laid out. This is useful for labels that are updated much more
+     * often than frames are drawn. Note that getSize() reflects the text last
+     * laid out until the update has happened.
+     * Disabling latched updates applies any pending text immediately.
+     */
+    void setLatchedUpdates(bool state = true);
+
+    bool hasLatchedUpdates() const;
+
+    virtual void preRenderUpdate();
+
     /**
      * If fontSize is -1, the actual font size used is calculated based on the
      * current height of the widget. Any widget size changes after this call do
@@ -64,8 +87,28 @@ public:
 
     void setTextProperty(TextProperty p);
 
+    /**
+     * Gets the alignment flags set by setTextProperty() (a combination of
+     * TextProperty values).
+     */
+    int getTextProperties() const;
+
+    /**
+     * Gets the length at which lines wrap, or -1 if wrapping is disabled.
+     */
+    int getLineLength() const;
+
+    /**
+     * Restores the text layout (see Text::restoreLayout()) and the line length
+     * of a Label that was set up like this one, and adapts size and alignment
+     * to it without measuring the text.
+     */
+    void restoreTextLayout(const TextLayout& layout, int lineLength);
+
     Text& getTextWidget();
 
+    const Text& getTextWidget() const;
+
     virtual void mouseMoved(MouseMovedEvent ev,
                             const Point& pos,
                             const Point& delta,
@@ -79,6 +122,21 @@ public:
 
     void setColors(const char* colorScheme);
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
+protected:
+
+    /**
+     * Lays out the given text immediately, regardless of latched updates.
+     */
+    void applyText(const std::string& text);
+
+    /**
+     * Registers this Label for a preRenderUpdate() call unless already
+     * registered for the upcoming frame.
+     */
+    void requestPreRenderUpdate();
+
 private:
 
     void updateTextAlignment();
@@ -119,6 +177,16 @@ private:
 
     int lineLength_;
 
+    bool bLatchedUpdates_;
+
+    /** Whether pendingText_ still needs to be laid out */
+    bool bTextPending_;
+
+    /** Whether a preRenderUpdate() call is already scheduled */
+    bool bPreRenderUpdateRequested_;
+
+    std::string pendingText_;
+
 };
 
 
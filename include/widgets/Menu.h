@@ -45,6 +45,8 @@ public:
 
     virtual void setColors(const char* colorScheme);
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 private:
 
     int getValidToken(int suggestedToken);
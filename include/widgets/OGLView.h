@@ -99,8 +99,17 @@ public:
 
     void setShadeColorScheme(const char* colorScheme);
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 protected:
 
+    /**
+     * Renders the content in GL coordinates. The transform is also loaded into
+     * OpenGL's matrix stack, so fixed-function drawing works on either render
+     * path. On the shader path, gw1k's primitives (see Render.h) ignore
+     * glTranslatef() and the like; use translateTransform() and friends
+     * instead (see RenderPipeline.h).
+     */
     virtual void renderOGLContent() const;
 
 private:
@@ -51,6 +51,8 @@ public:
 
     void setShadeColorScheme(const char* colorScheme);
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 private:
 
     OGLViewWiBox_OGLRenderer* oglRenderer_;
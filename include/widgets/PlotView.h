@@ -0,0 +1,255 @@
+#ifndef GW1K_PLOTVIEW_H_
+#define GW1K_PLOTVIEW_H_
+
+#include "OGLView.h"
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+
+namespace gw1k
+{
+
+
+/**
+ * PlotView displays a time series (e.g., a sensor trace) of up to several
+ * million samples. Sample i is drawn at x = i * sample spacing, with its value
+ * as y; panning and zooming work like in OGLView (mouse control is enabled by
+ * default).
+ *
+ * Samples are kept in a ring of fixed-size chunks, so once the capacity is
+ * reached, the oldest chunk is dropped and its memory reused. Each chunk holds
+ * a min/max pyramid of its samples, which is updated as samples are added.
+ * When rendering, the pyramid level that matches the current zoom is used to
+ * determine the value range of each pixel column, so at most two vertices per
+ * horizontal pixel are drawn, regardless of the number of visible samples.
+ * The vertices are kept in a buffer object; when samples are appended while
+ * the view stays the same, only the vertices of the affected columns are
+ * recalculated and uploaded.
+ *
+ * Instead of copying samples into the ring buffer, PlotView can also plot
+ * samples from an externally owned buffer or a memory-mapped file (see
+ * setExternalSamples() and mapSampleFile()).
+ */
+class PlotView : public OGLView
+{
+
+public:
+
+    /**
+     * capacity is the number of samples that are kept at least; it is rounded
+     * up to a multiple of the chunk size (4096).
+     */
+    PlotView(const Point& pos,
+             const Point& size,
+             unsigned long capacity = 1 << 20,
+             const char* lineColorScheme = 0);
+
+    virtual ~PlotView();
+
+public:
+
+    void addSample(float value);
+
+    /**
+     * Adds n samples, taking every stride-th float from values (e.g., one
+     * channel of interleaved data). Must not be called while external samples
+     * are set.
+     */
+    void addSamples(const float* values,
+                    unsigned long n,
+                    unsigned int stride = 1);
+
+    /**
+     * Plots n samples from an externally owned buffer, taking every stride-th
+     * float of data, without copying them. data must stay valid until other
+     * samples are set, clear() is called or the PlotView is destroyed. The ring
+     * buffer is not used meanwhile, so all n samples are kept.
+     *
+     * If data and stride are the same as in the previous call and n is not
+     * smaller, the previously set samples are assumed to be unchanged and only
+     * the appended ones are processed, so a producer can append to the buffer
+     * and call this method with the new count each time.
+     */
+    void setExternalSamples(const float* data,
+                            unsigned long n,
+                            unsigned int stride = 1);
+
+    /**
+     * Maps the given file of (native byte order) floats into memory and plots
+     * its contents as external samples. Calling this again for the same file
+     * after it has grown only processes the appended samples. Returns false if
+     * the file cannot be mapped.
+     */
+    bool mapSampleFile(const std::string& filename);
+
+    /**
+     * Removes all samples, including external ones, and returns to using the
+     * ring buffer. Sample indices start at 0 again.
+     */
+    void clear();
+
+    /**
+     * Gets the number of samples added (or set externally) per second,
+     * measured over intervals of at least one second.
+     */
+    double getIngestionRate() const;
+
+    /**
+     * Gets the index of the oldest sample that is still kept.
+     */
+    unsigned long getFirstSampleIndex() const;
+
+    /**
+     * Gets the index that the next added sample will get.
+     */
+    unsigned long getEndSampleIndex() const;
+
+    /**
+     * Gets the sample at index, which must be in the range
+     * [getFirstSampleIndex(), getEndSampleIndex()).
+     */
+    float getSample(unsigned long index) const;
+
+    /**
+     * Gets the minimum and maximum of the samples in [begin, end). The range is
+     * clipped to the samples that are kept; returns false if it is empty.
+     */
+    bool getSampleRange(unsigned long begin,
+                        unsigned long end,
+                        float& min,
+                        float& max) const;
+
+    /**
+     * Sets the distance of two successive samples on the x axis, in OpenGL
+     * units. The default is 0.001.
+     */
+    void setSampleSpacing(float dx);
+
+    float getSampleSpacing() const;
+
+    void setLineColors(const ColorTable& colorTable);
+
+    /**
+     * Sets the line colours from the Line colours of the given scheme (default
+     * is PlotView.Line); if no foreground colours are specified, white is used.
+     */
+    void setLineColorScheme(const char* colorScheme);
+
+    virtual void accountMemory(MemoryFootprint& f) const;
+
+protected:
+
+    virtual void renderOGLContent() const;
+
+private:
+
+    struct Chunk
+    {
+        std::vector<float> samples;
+
+        /**
+         * Pyramid levels 1 to CHUNK_BITS, where level l holds the minima
+         * (maxima) of blocks of 2^l samples, starting at levelOffset(l)
+         */
+        std::vector<float> mins;
+
+        std::vector<float> maxs;
+    };
+
+    static unsigned int levelOffset(unsigned int level);
+
+    Chunk& chunkOf(unsigned long index) const;
+
+    /**
+     * Recalculates the pyramid entries of chunk c that depend on the samples
+     * in [begin, end), where end is the number of samples in the chunk. The
+     * chunk's samples are taken from every stride-th float of samples.
+     */
+    static void updatePyramid(Chunk& c,
+                              const float* samples,
+                              unsigned int stride,
+                              unsigned int begin,
+                              unsigned int end);
+
+    /**
+     * Sets external samples; if bAppend is true, only samples from end_ on are
+     * new.
+     */
+    void attachExternalSamples(const float* data,
+                               unsigned long n,
+                               unsigned int stride,
+                               bool bAppend);
+
+    void unmapSampleFile();
+
+    void samplesAdded(unsigned long begin, unsigned long n);
+
+    /**
+     * Updates vertices_ with the vertices to render for samples [begin, end),
+     * given the number of samples per pixel column. Returns the index of the
+     * first element of vertices_ that changed since the last call.
+     */
+    unsigned int buildVertices(unsigned long begin,
+                               unsigned long end,
+                               double pxSamples) const;
+
+    void drawVertices(unsigned int changedFrom) const;
+
+private:
+
+    std::vector<Chunk*> chunks_;
+
+    /** Number of chunks of the ring buffer */
+    unsigned int ringChunks_;
+
+    unsigned long first_;
+
+    unsigned long end_;
+
+    float dx_;
+
+    ColorTable lineColorTable_;
+
+    const float* extData_;
+
+    unsigned int extStride_;
+
+    void* mappedData_;
+
+    unsigned long mappedSize_;
+
+    std::string mappedFile_;
+
+    unsigned long ingested_;
+
+    double rateStart_;
+
+    double rate_;
+
+    /** Index of the first sample added since the vertices were built */
+    mutable unsigned long dirtyFrom_;
+
+    mutable std::vector<float> vertices_;
+
+    /** View parameters that vertices_ was built for */
+    mutable bool bVerticesDirect_;
+
+    mutable double verticesPxSamples_;
+
+    mutable double verticesStart_;
+
+    mutable unsigned long verticesFirst_;
+
+    mutable GLuint vbo_;
+
+    /** Size of vbo_'s data store in floats */
+    mutable unsigned int vboCapacity_;
+
+};
+
+
+} // namespace gw1k
+
+#endif // GW1K_PLOTVIEW_H_
@@ -44,6 +44,8 @@ public:
 
     virtual void setColors(const char* colorScheme);
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 private:
 
     void updateRangeBar();
@@ -0,0 +1,179 @@
+#ifndef GW1K_SCATTERVIEW_H_
+#define GW1K_SCATTERVIEW_H_
+
+#include "OGLView.h"
+#include "../providers/ActionEventProvider.h"
+
+#include <GL/glew.h>
+
+#include <vector>
+
+namespace gw1k
+{
+
+
+/**
+ * ScatterView displays a point cloud of up to millions of points, each with
+ * its own colour and size (in pixels). Point attributes are kept in buffer
+ * objects, and only the points added or changed since the last frame are
+ * uploaded. Per-point sizes require shader support; otherwise, all points are
+ * drawn with the default size.
+ *
+ * Hovering is resolved through a uniform grid over the points' GL coordinates,
+ * so finding the point under the mouse only looks at the points near it.
+ * Points added later are inserted into the existing grid; it is only rebuilt
+ * if they fall outside of it or the number of points has doubled. When
+ * the hovered point changes, action listeners are informed (see
+ * getHoveredPoint()).
+ */
+class ScatterView : public OGLView, public ActionEventProvider
+{
+
+public:
+
+    ScatterView(const Point& pos,
+                const Point& size,
+                const char* shadeColorScheme = 0);
+
+    virtual ~ScatterView();
+
+public:
+
+    /**
+     * Adds a point and returns its index.
+     */
+    unsigned int addPoint(const geom::Point2D& p,
+                          const Color4i& color = Color4i(255, 255, 255),
+                          float size = 4.f);
+
+    /**
+     * Adds n points from xy (pairs of coordinates), with the default colour
+     * and size.
+     */
+    void addPoints(const float* xy, unsigned int n);
+
+    void clear();
+
+    unsigned int getNumPoints() const;
+
+    geom::Point2D getPoint(unsigned int i) const;
+
+    void setPointColor(unsigned int i, const Color4i& color);
+
+    void setPointSize(unsigned int i, float size);
+
+    void setDefaultPointColor(const Color4i& color);
+
+    void setDefaultPointSize(float size);
+
+    /**
+     * Gets the index of the point closest to relPos (relative to the widget
+     * position) whose disc (point size plus radius pixels) contains relPos, or
+     * -1 if there is none.
+     */
+    int pickPoint(const Point& relPos, int radius = 2) const;
+
+    /**
+     * Gets the index of the point under the mouse, or -1 if there is none.
+     */
+    int getHoveredPoint() const;
+
+    virtual void mouseMoved(MouseMovedEvent ev,
+                            const Point& pos,
+                            const Point& delta,
+                            GuiObject* receiver);
+
+    virtual void accountMemory(MemoryFootprint& f) const;
+
+protected:
+
+    virtual void renderOGLContent() const;
+
+private:
+
+    /**
+     * Brings the picking grid up to date, inserting the points added since
+     * the last update or rebuilding the grid if necessary.
+     */
+    void updateGrid() const;
+
+    /**
+     * Rebuilds the picking grid for all points. The grid's bounds are those of
+     * the points, extended by margin times their extent on each side.
+     */
+    void buildGrid(float margin) const;
+
+    void markChanged(unsigned int i);
+
+    /**
+     * Uploads the attributes of points changed since the last call, growing
+     * the buffers if needed.
+     */
+    void uploadPoints() const;
+
+    void setHoveredPoint(int i);
+
+private:
+
+    /** Interleaved x and y coordinates */
+    std::vector<float> positions_;
+
+    /** RGBA colours */
+    std::vector<unsigned char> colors_;
+
+    std::vector<float> sizes_;
+
+    float maxSize_;
+
+    Color4i defaultColor_;
+
+    float defaultSize_;
+
+    int hoveredPoint_;
+
+    /** Index of the first point that changed since the last upload */
+    mutable unsigned int changedFrom_;
+
+    mutable bool bBuffersCreated_;
+
+    /** Buffer objects for positions, colours and sizes */
+    mutable GLuint vbos_[3];
+
+    /** Number of points the buffer objects have room for */
+    mutable unsigned int vboCapacity_;
+
+    mutable GLuint program_;
+
+    mutable GLint sizeAttrib_;
+
+    /**
+     * The picking grid: the points in cell c = y * gridW_ + x are chained,
+     * starting at point cellHead_[c] and continuing with nextInCell_[i] for
+     * each point i, up to -1
+     */
+    mutable bool bGridDirty_;
+
+    mutable geom::Point2D gridMin_;
+
+    mutable geom::Point2D cellSize_;
+
+    mutable int gridW_;
+
+    mutable int gridH_;
+
+    mutable std::vector<int> cellHead_;
+
+    mutable std::vector<int> nextInCell_;
+
+    /** Number of points inserted into the grid (the first ones) */
+    mutable unsigned int gridPoints_;
+
+    /** Number of points at the last rebuild of the grid */
+    mutable unsigned int builtPoints_;
+
+};
+
+
+} // namespace gw1k
+
+#endif // GW1K_SCATTERVIEW_H_
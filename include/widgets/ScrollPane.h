@@ -70,6 +70,11 @@ public:
      */
     virtual void removeSubObject(GuiObject* o);
 
+    /**
+     * See removeSubObject()
+     */
+    virtual void removeSubObjects(const std::vector<GuiObject*>& objects);
+
     /**
      * See removeSubObject()
      */
@@ -86,8 +91,29 @@ public:
      */
     void refreshLayout();
 
+    /**
+     * Like refreshLayout(), but only takes into account that the given
+     * sub-object has been moved or resized, which takes logarithmic instead of
+     * linear time in the number of sub-objects. Objects that are not
+     * sub-objects are ignored with a warning.
+     */
+    void refreshLayout(GuiObject* o);
+
     virtual void setColors(const char* colorScheme);
 
+    /**
+     * Enables or disables keeping the visible content in an offscreen texture,
+     * so scrolling only renders the newly exposed content. This is intended for
+     * heavy content that rarely changes; see ClippingBox::setScrollCaching().
+     */
+    void setScrollCaching(bool enabled);
+
+    /**
+     * Makes the next frame re-render all visible content when scroll caching
+     * is enabled. Call this when sub-objects change their appearance.
+     */
+    void invalidateScrollCache();
+
     const Point& getVisibleSize() const;
 
     Slider& getHSlider();
@@ -107,6 +133,8 @@ public:
 
     virtual int getNumSubObjects() const;
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 protected:
 
     /**
@@ -59,6 +59,8 @@ public:
 
     float getMouseWheelStep() const;
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 private:
 
     void init(const char* colorScheme);
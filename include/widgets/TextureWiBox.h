@@ -41,6 +41,8 @@ public:
 
     virtual const Point& setSize(float width, float height);
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 protected:
 
     TextureView* texView_;
@@ -8,6 +8,17 @@ namespace gw1k
 {
 
 
+/**
+ * WiBox is a Box drawn with the foreground colour as border and the background
+ * colour as fill. The theme can additionally give it rounded corners, a wider
+ * border, and a vertical gradient fill:
+ *
+ *     WiBox = { ..., radius = 4, border = 2, Gradient = { #, Green } }
+ *
+ * where the background colours of the Gradient scheme are the colours at the
+ * bottom edge. Such styled boxes are drawn in a single draw call (see
+ * drawStyledRect()).
+ */
 class WiBox : public Box
 {
 
@@ -27,6 +38,51 @@ public:
 
     virtual void setColors(const char* colorScheme);
 
+    void setCornerRadius(float radius);
+
+    float getCornerRadius() const;
+
+    void setBorderWidth(float width);
+
+    float getBorderWidth() const;
+
+    /**
+     * Sets the background colours at the bottom edge; with any of them set,
+     * the background is filled with a gradient.
+     */
+    void setGradientColors(const ColorTable& ct);
+
+    const ColorTable& getGradientColors() const;
+
+    virtual void accountMemory(MemoryFootprint& f) const;
+
+protected:
+
+    /**
+     * Reads corner radius, border width, and gradient colours of the given
+     * scheme from the theme.
+     */
+    void setStyle(const char* colorScheme, const char* fallbackScheme);
+
+private:
+
+    /**
+     * Returns whether the box needs drawStyledRect(), or can be drawn with a
+     * plain rectangle and outline.
+     */
+    bool isStyled() const;
+
+    void renderStyled(const Point& offset, bool bFill) const;
+
+private:
+
+    float cornerRadius_;
+
+    float borderWidth_;
+
+    /** Background colours at the bottom edge, for a gradient fill */
+    ColorTable gradientColors_;
+
 };
 
 
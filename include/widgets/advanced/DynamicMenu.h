@@ -26,6 +26,8 @@ public:
 
     void removeAllEntries();
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 private:
 
     typedef Menu super;
@@ -43,6 +43,8 @@ public:
 
     void setColors(const char* colorScheme);
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 protected:
 
     void updateLabels();
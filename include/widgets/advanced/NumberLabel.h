@@ -35,10 +35,18 @@ public:
     void setPrecision(int precision);
 
     /**
-     * Sets the number to display.
+     * Sets the number to display. If latched updates are enabled (see
+     * Label::setLatchedUpdates()), the number is formatted immediately, but
+     * laid out only once before the next frame is rendered, like text set by
+     * setText().
      */
     void setNumber(float number);
 
+    /**
+     * Gets the number most recently set.
+     */
+    float getNumber() const;
+
     /**
      * Forwards number to setNumber(float), but sets the number of decimal
      * places to zero.
@@ -62,9 +70,20 @@ public:
      */
     void setNumberSpace(int n);
 
+    /**
+     * Replaces the formatted number by text until the number is set again (see
+     * Label::setText()).
+     */
+    virtual void setText(const std::string& text);
+
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 private:
 
-    std::string toStr(float f) const;
+    /**
+     * Formats the number and sets the resulting text (see Label::setText()).
+     */
+    void refreshText();
 
 private:
 
@@ -83,6 +102,15 @@ private:
      * ignored.
      */
     unsigned int numberSpace_;
+
+    /**
+     * Whether the text shows the formatted number_, i.e., it has been
+     * formatted and not been replaced by setText() since
+     */
+    bool bFormatted_;
+
+    /** Reused for assembling the text to avoid allocations per update */
+    std::string textBuf_;
 };
 
 
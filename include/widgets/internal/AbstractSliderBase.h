@@ -49,6 +49,8 @@ public:
 
     const float* getRange() const;
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 protected:
 
     /** internalVal should be from the range [0, 1]. */
@@ -39,6 +39,8 @@ public:
 
     virtual void setColors(const char* colorScheme);
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 private:
 
     int token_;
@@ -12,6 +12,38 @@ namespace gw1k
 {
 
 
+/**
+ * The font and measurements of a laid-out Text, which allow restoring its
+ * layout without measuring the text again (see Text::restoreLayout()).
+ */
+struct TextLayout
+{
+
+    TextLayout();
+
+    std::string fontName;
+
+    /** The requested face size */
+    unsigned int faceSize;
+
+    /** The font as returned by FTGLFontManager::GetRenderFont() */
+    FTFont* font;
+
+    /** The scale returned along with font */
+    float fontScale;
+
+    /** The text's bounding box, in font units */
+    FTBBox bbox;
+
+    /** Whether the line length is set (i.e., the text wraps) */
+    bool bLineLengthSet;
+
+    /** The width of the text (the line length if set) */
+    int width;
+
+};
+
+
 /**
  * Text is a pretty basic class that is not intended to be used directly as a
  * widget. Instead, use a (auto-sized) Label without decoration if you need to
@@ -46,6 +78,31 @@ public:
 
     void setFont(const std::string& name, unsigned int faceSize);
 
+    const std::string& getFontName() const;
+
+    /**
+     * Gets the current font and measurements; font and fontScale are set to 0
+     * if no font is set.
+     */
+    void getLayout(TextLayout& layout) const;
+
+    /**
+     * Sets font and measurements as taken from a Text with the same text and
+     * alignment by getLayout(), without looking up the font or measuring the
+     * text. layout.font must have been obtained by
+     * FTGLFontManager::GetRenderFont() for layout.fontName and layout.faceSize.
+     */
+    void restoreLayout(const TextLayout& layout);
+
+    /**
+     * Defers font lookups of all Texts: while deferred, setFont() only stores
+     * name and face size, and since Texts without font are not measured,
+     * creating and setting up Texts is cheap. Their layout must then be set by
+     * restoreLayout(). This is used when widgets are created in bulk (see
+     * WidgetSnapshot).
+     */
+    static void setFontLookupsDeferred(bool state = true);
+
     void setHorizontalAlignment(TextProperty alignment);
 
     /**
@@ -70,6 +127,8 @@ public:
 
     virtual void setColors(const char* colorScheme);
 
+    virtual void accountMemory(MemoryFootprint& f) const;
+
 private:
 
     void updateBBox();
@@ -96,6 +155,19 @@ protected:
 
     std::string fontName_;
 
+    /** The requested face size, which may differ from font_'s face size */
+    unsigned int faceSize_;
+
+    /**
+     * The factor by which font_'s glyphs are scaled to appear in faceSize_;
+     * layout_ and ftBB_ are in unscaled font units
+     */
+    float fontScale_;
+
+private:
+
+    static bool bFontLookupsDeferred_;
+
 };
 
 
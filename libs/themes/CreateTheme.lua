@@ -221,6 +221,16 @@ local function is_selector(key)
 end
 
 
+-- Style properties that widgets read as plain numbers instead of colors (e.g.,
+-- WiBox { radius = 4 })
+local properties = { radius = true, border = true }
+
+
+local function is_property(key)
+    return properties[key]
+end
+
+
 local function is_color(t)
     return (type(t) == "table") and (t.rgba ~= nil)
 end
@@ -297,7 +307,13 @@ local function process_theme(path, key, value, level, idx)
 
         DEBUGPRINT(level, "found key ", key, " of type string")
 
-        if type(value) == "number" or is_color(value) or value == _nocolor then
+        if level > 0 and is_property(key) and type(value) == "number" then
+
+            DEBUGPRINT(level, "found style property ", key, " = ", value)
+
+            themeTable[path .. "." .. key] = value
+
+        elseif type(value) == "number" or is_color(value) or value == _nocolor then
 
             DEBUGPRINT(level, "found value ", value, " of type " .. ctype(value))
 
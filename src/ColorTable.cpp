@@ -18,6 +18,12 @@ ColorTable::ColorTable()
 
 
 ColorTable::ColorTable(const ColorTable& ct)
+:   fgCol(0),
+    bgCol(0),
+    hoveredFgCol(0),
+    hoveredBgCol(0),
+    clickedFgCol(0),
+    clickedBgCol(0)
 {
     *this = ct;
 }
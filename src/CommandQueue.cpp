@@ -0,0 +1,269 @@
+#include "CommandQueue.h"
+
+#include <algorithm>
+#include <map>
+
+// The atomic operations below use GCC's __sync builtins, which imply a full
+// memory barrier.
+
+namespace gw1k
+{
+
+
+CommandQueue::CommandQueue()
+:   head_(0),
+    backlog_(0),
+    capacity_(0),
+    pending_(0),
+    maxPending_(0),
+    posted_(0),
+    executed_(0),
+    coalesced_(0),
+    rejected_(0)
+{}
+
+
+CommandQueue::~CommandQueue()
+{
+    deleteAll(backlog_);
+    deleteAll(takeAll());
+}
+
+
+bool
+CommandQueue::post(Command* c)
+{
+    if (!c)
+    {
+        return false;
+    }
+
+    unsigned int pending = __sync_add_and_fetch(&pending_, 1);
+    if ((capacity_ != 0) && (pending > capacity_))
+    {
+        __sync_sub_and_fetch(&pending_, 1);
+        __sync_add_and_fetch(&rejected_, 1);
+        delete c;
+        return false;
+    }
+
+    // Statistics only, so a lost update in a race is acceptable
+    if (pending > maxPending_)
+    {
+        maxPending_ = pending;
+    }
+    __sync_add_and_fetch(&posted_, 1);
+
+    Command* head;
+    do
+    {
+        head = head_;
+        c->next_ = head;
+    }
+    while (!__sync_bool_compare_and_swap(&head_, head, c));
+
+    return true;
+}
+
+
+void
+CommandQueue::execute()
+{
+    Command* c = takeAll();
+    if (backlog_)
+    {
+        Command* last = backlog_;
+        while (last->next_)
+        {
+            last = last->next_;
+        }
+        last->next_ = c;
+        c = backlog_;
+        backlog_ = 0;
+    }
+
+    if (!c)
+    {
+        return;
+    }
+
+    std::vector<Command*> cmds;
+    for (; c; c = c->next_)
+    {
+        cmds.push_back(c);
+    }
+    __sync_sub_and_fetch(&pending_, cmds.size());
+
+    // Walk from newest to oldest and drop every command that is superseded by
+    // a later one; candidates are looked up by target so this stays cheap for
+    // large batches
+    typedef std::multimap<const void*, Command*> TargetMap;
+    typedef TargetMap::const_iterator TargetMapIter;
+    TargetMap latest;
+    std::vector<bool> bSuperseded(cmds.size(), false);
+
+    for (int i = cmds.size() - 1; i >= 0; --i)
+    {
+        Command* cmd = cmds[i];
+        std::pair<TargetMapIter, TargetMapIter> r =
+            latest.equal_range(cmd->getTarget());
+        for (TargetMapIter j = r.first; j != r.second; ++j)
+        {
+            if (j->second->isSameUpdate(*cmd))
+            {
+                bSuperseded[i] = true;
+                break;
+            }
+        }
+
+        if (!bSuperseded[i])
+        {
+            latest.insert(std::make_pair(cmd->getTarget(), cmd));
+        }
+    }
+
+    for (unsigned int i = 0; i != cmds.size(); ++i)
+    {
+        if (bSuperseded[i])
+        {
+            ++coalesced_;
+        }
+        else
+        {
+            cmds[i]->execute();
+            ++executed_;
+        }
+        delete cmds[i];
+    }
+}
+
+
+void
+CommandQueue::removeCommands(const std::vector<const void*>& targets)
+{
+    if (!targets.empty())
+    {
+        removeCommands(&targets[0], &targets[0] + targets.size());
+    }
+}
+
+
+void
+CommandQueue::removeCommands(const void* target)
+{
+    removeCommands(&target, &target + 1);
+}
+
+
+void
+CommandQueue::removeCommands(const void* const* begin, const void* const* end)
+{
+    if (!backlog_ && !head_)
+    {
+        return;
+    }
+
+    // Commands posted meanwhile are appended to the backlog, which keeps them
+    // in posting order and behind the ones taken earlier
+    Command** tail = &backlog_;
+    while (*tail)
+    {
+        tail = &(*tail)->next_;
+    }
+    *tail = takeAll();
+
+    unsigned int removed = 0;
+    for (Command** c = &backlog_; *c; )
+    {
+        if (std::binary_search(begin, end, (*c)->getTarget()))
+        {
+            Command* next = (*c)->next_;
+            delete *c;
+            *c = next;
+            ++removed;
+        }
+        else
+        {
+            c = &(*c)->next_;
+        }
+    }
+
+    if (removed)
+    {
+        __sync_sub_and_fetch(&pending_, removed);
+    }
+}
+
+
+void
+CommandQueue::setCapacity(unsigned int capacity)
+{
+    capacity_ = capacity;
+}
+
+
+unsigned int
+CommandQueue::getCapacity() const
+{
+    return capacity_;
+}
+
+
+CommandQueue::Stats
+CommandQueue::getStats() const
+{
+    Stats s;
+    s.posted = posted_;
+    s.executed = executed_;
+    s.coalesced = coalesced_;
+    s.rejected = rejected_;
+    s.pending = pending_;
+    s.maxPending = maxPending_;
+    return s;
+}
+
+
+void
+CommandQueue::resetStats()
+{
+    posted_ = 0;
+    executed_ = 0;
+    coalesced_ = 0;
+    rejected_ = 0;
+    maxPending_ = pending_;
+}
+
+
+Command*
+CommandQueue::takeAll()
+{
+    Command* c = __sync_lock_test_and_set(&head_, static_cast<Command*>(0));
+    __sync_synchronize();
+
+    // The list is in reverse posting order, so reverse it
+    Command* prev = 0;
+    while (c)
+    {
+        Command* next = c->next_;
+        c->next_ = prev;
+        prev = c;
+        c = next;
+    }
+    return prev;
+}
+
+
+/*static*/
+void
+CommandQueue::deleteAll(Command* c)
+{
+    while (c)
+    {
+        Command* next = c->next_;
+        delete c;
+        c = next;
+    }
+}
+
+
+} // namespace gw1k
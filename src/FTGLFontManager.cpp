@@ -5,15 +5,132 @@
 #include "FTGLFontManager.h"
 
 #include "Log.h"
+#include "Command.h"
+#include "WManager.h"
+
+#include <GL/glfw.h>
 
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <set>
 
 namespace gw1k
 {
 
 
-typedef std::map<std::string, FTFont*> FontList;
+namespace
+{
+
+
+/**
+ * Rough number of glyphs per font that end up in glyph textures; FTGL does not
+ * expose its glyph textures, so the memory of a font is estimated from this and
+ * the face size (at one byte per texel)
+ */
+const unsigned long ESTIMATED_GLYPHS_PER_FONT = 128;
+
+/** Interval at which the GUI thread polls for the end of preloading, in s */
+const double PRELOAD_POLL_INTERVAL = 0.01;
+
+
+} // namespace
+
+
+/**
+ * Hands the contents of a font file read by the preload thread over to the
+ * GUI thread.
+ */
+class FontDataCommand : public Command
+{
+
+public:
+
+    FontDataCommand(const std::string& filename,
+                    std::vector<unsigned char>* data)
+    :   filename_(filename),
+        data_(data)
+    {}
+
+    virtual ~FontDataCommand()
+    {
+        delete data_;
+    }
+
+    virtual void execute()
+    {
+        FTGLFontManager::Instance().createPreloadedFonts(filename_, data_);
+        data_ = 0;
+    }
+
+private:
+
+    std::string filename_;
+
+    std::vector<unsigned char>* data_;
+
+};
+
+
+namespace
+{
+
+
+struct PreloadJob
+{
+    std::vector<std::string> filenames;
+
+    /** Obtained on the GUI thread, as WManager's creation is not thread-safe */
+    WManager* wm;
+
+    /** Set when all files have been read */
+    volatile int* done;
+};
+
+
+void GLFWCALL
+preloadFonts(void* arg)
+{
+    PreloadJob* job = static_cast<PreloadJob*>(arg);
+    WManager* wm = job->wm;
+
+    for (unsigned int i = 0; i != job->filenames.size(); ++i)
+    {
+        const std::string& filename = job->filenames[i];
+        std::string fullname = "fonts/" + filename;
+
+        std::vector<unsigned char>* data = 0;
+        std::ifstream file(fullname.c_str(), std::ios::in | std::ios::binary);
+        if (file)
+        {
+            file.seekg(0, std::ios::end);
+            std::streamoff length = file.tellg();
+            file.seekg(0, std::ios::beg);
+            if (length > 0)
+            {
+                data = new std::vector<unsigned char>(length);
+                file.read(reinterpret_cast<char*>(&(*data)[0]), length);
+                if (!file)
+                {
+                    delete data;
+                    data = 0;
+                }
+            }
+        }
+
+        // A missing file is reported to the GUI thread as well (data is 0), so
+        // the failure is counted there; if the command is rejected, the fonts
+        // are simply loaded on first use
+        wm->postCommand(new FontDataCommand(filename, data));
+    }
+
+    volatile int* done = job->done;
+    delete job;
+    __sync_lock_test_and_set(done, 1);
+}
+
+
+} // namespace
 
 
 /*static*/
@@ -30,7 +147,7 @@ FTGLFontManager::~FTGLFontManager()
     for(FontList::iterator font = fonts_.begin(); font != fonts_.end(); font++)
     {
         // TODO Find out why delete segfaults; cleanup() is used meanwhile
-        //delete (*font).second;
+        //delete (*font).second.font;
     }
 
     fonts_.clear();
@@ -42,10 +159,28 @@ FTGLFontManager::cleanup()
 {
     for(FontList::iterator font = fonts_.begin(); font != fonts_.end(); font++)
     {
-        delete (*font).second;
+        delete (*font).second.font;
+    }
+
+    if (preloadThread_ >= 0)
+    {
+        glfwWaitThread(preloadThread_, GLFW_WAIT);
+        preloadThread_ = -1;
     }
 
     fonts_.clear();
+    fontEntries_.clear();
+    preloadedFonts_.clear();
+    bytes_ = 0;
+    measureMap_.clear();
+    measureList_.clear();
+
+    for (std::map<std::string, FaceData*>::iterator it = faceData_.begin();
+         it != faceData_.end(); ++it)
+    {
+        delete it->second;
+    }
+    faceData_.clear();
 }
 
 
@@ -53,22 +188,26 @@ FTGLFontManager::cleanup()
 FTFont*
 FTGLFontManager::GetFont(const char *filename, int size)
 {
-    char buf[256];
-    sprintf(buf, "%s%i", filename, size);
-    std::string fontKey(buf);
+    std::pair<std::string, int> fontKey(filename, size);
 
     FontList::iterator result = fonts_.find(fontKey);
     if(result != fonts_.end())
     {
         //Log::info("FTGLFontManager", Log::os() << "Found font " << filename
         //    << " in list");
-        return result->second;
+        ++hits_;
+        result->second.lastUse = ++useCounter_;
+        return result->second.font;
     }
 
     std::string fullname = "fonts/" + std::string(filename);
 
     // TODO Better use FTBufferFont (for performance)?
-    FTFont* font = new FTTextureFont(fullname.c_str());
+    std::map<std::string, FaceData*>::iterator data =
+        faceData_.find(std::string(filename));
+    FTFont* font = (data != faceData_.end())
+        ? new FTTextureFont(&(*data->second)[0], data->second->size())
+        : new FTTextureFont(fullname.c_str());
 
 
 
@@ -88,10 +227,442 @@ FTGLFontManager::GetFont(const char *filename, int size)
         return 0;
     }
 
-    fonts_[fontKey] = font;
+    ++misses_;
+
+    FontEntry entry;
+    entry.font = font;
+    entry.refs = 0;
+    entry.lastUse = ++useCounter_;
+    entry.bytes = ESTIMATED_GLYPHS_PER_FONT * size * size;
+    fontEntries_[font] = fonts_.insert(std::make_pair(fontKey, entry)).first;
+    bytes_ += entry.bytes;
+
+    // Make sure the new font survives eviction until the caller acquires it
+    ++fontEntries_[font]->second.refs;
+    evictFonts();
+    --fontEntries_[font]->second.refs;
 
     return font;
 }
 
 
+void
+FTGLFontManager::AcquireFont(FTFont* font)
+{
+    std::map<FTFont*, FontList::iterator>::iterator e = fontEntries_.find(font);
+    if (e != fontEntries_.end())
+    {
+        ++e->second->second.refs;
+    }
+}
+
+
+void
+FTGLFontManager::ReleaseFont(FTFont* font)
+{
+    // Unknown fonts are ignored, as fonts may have been deleted by cleanup()
+    std::map<FTFont*, FontList::iterator>::iterator e = fontEntries_.find(font);
+    if ((e != fontEntries_.end()) && (e->second->second.refs > 0))
+    {
+        --e->second->second.refs;
+    }
+}
+
+
+void
+FTGLFontManager::SetMemoryBudget(unsigned long bytes)
+{
+    memoryBudget_ = bytes;
+    evictFonts();
+}
+
+
+FTGLFontManager::CacheStats
+FTGLFontManager::GetCacheStats() const
+{
+    CacheStats stats;
+    stats.fonts = fonts_.size();
+    stats.referencedFonts = 0;
+    for (FontList::const_iterator f = fonts_.begin(); f != fonts_.end(); ++f)
+    {
+        if (f->second.refs > 0)
+        {
+            ++stats.referencedFonts;
+        }
+    }
+    stats.bytes = bytes_;
+    stats.budget = memoryBudget_;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    return stats;
+}
+
+
+void
+FTGLFontManager::evictFonts()
+{
+    while ((memoryBudget_ != 0) && (bytes_ > memoryBudget_))
+    {
+        FontList::iterator lru = fonts_.end();
+        for (FontList::iterator f = fonts_.begin(); f != fonts_.end(); ++f)
+        {
+            if ((f->second.refs == 0)
+                && ((lru == fonts_.end())
+                    || (f->second.lastUse < lru->second.lastUse)))
+            {
+                lru = f;
+            }
+        }
+
+        if (lru == fonts_.end())
+        {
+            // Only referenced fonts left
+            break;
+        }
+
+        removeFont(lru);
+        ++evictions_;
+    }
+}
+
+
+void
+FTGLFontManager::removeFont(FontList::iterator entry)
+{
+    FTFont* font = entry->second.font;
+
+    // Drop cached measurements, as a new font may get the same address
+    MeasureList::iterator m = measureList_.begin();
+    while (m != measureList_.end())
+    {
+        if (m->first.font == font)
+        {
+            measureMap_.erase(m->first);
+            m = measureList_.erase(m);
+        }
+        else
+        {
+            ++m;
+        }
+    }
+
+    preloadedFonts_.erase(font);
+    fontEntries_.erase(font);
+    bytes_ -= entry->second.bytes;
+    fonts_.erase(entry);
+    delete font;
+}
+
+
+FTFont*
+FTGLFontManager::GetRenderFont(const char* filename, int size, float& scale)
+{
+    static const int MAX_RENDER_SIZE = 128;
+
+    int renderSize = size;
+    if (bScaledRendering_ && (size > 0) && (size <= MAX_RENDER_SIZE))
+    {
+        // Downscaling gives better results than upscaling, so use the smallest
+        // rendering size that is not smaller than the requested one
+        renderSize = 16;
+        while (renderSize < size)
+        {
+            renderSize *= 2;
+        }
+    }
+
+    scale = (renderSize == size) ? 1.f : float(size) / float(renderSize);
+    return GetFont(filename, renderSize);
+}
+
+
+void
+FTGLFontManager::SetScaledRendering(bool enabled)
+{
+    bScaledRendering_ = enabled;
+}
+
+
+bool
+FTGLFontManager::IsScaledRendering() const
+{
+    return bScaledRendering_;
+}
+
+
+FTBBox
+FTGLFontManager::MeasureText(FTSimpleLayout& layout, const std::string& text)
+{
+    if (maxMeasureEntries_ == 0)
+    {
+        return layout.BBox(text.c_str());
+    }
+
+    MeasureKey key;
+    key.font = layout.GetFont();
+    key.lineLength = layout.GetLineLength();
+    key.lineSpacing = layout.GetLineSpacing();
+    key.alignment = layout.GetAlignment();
+    key.text = text;
+
+    MeasureMap::iterator result = measureMap_.find(key);
+    if (result != measureMap_.end())
+    {
+        // Move entry to the front of the LRU list
+        measureList_.splice(measureList_.begin(), measureList_, result->second);
+        return result->second->second;
+    }
+
+    FTBBox bbox = layout.BBox(text.c_str());
+
+    measureList_.push_front(std::make_pair(key, bbox));
+    measureMap_[key] = measureList_.begin();
+
+    while (measureMap_.size() > maxMeasureEntries_)
+    {
+        measureMap_.erase(measureList_.back().first);
+        measureList_.pop_back();
+    }
+
+    return bbox;
+}
+
+
+void
+FTGLFontManager::SetMeasureCacheSize(unsigned int maxEntries)
+{
+    maxMeasureEntries_ = maxEntries;
+    while (measureMap_.size() > maxMeasureEntries_)
+    {
+        measureMap_.erase(measureList_.back().first);
+        measureList_.pop_back();
+    }
+}
+
+
+bool
+FTGLFontManager::MeasureKey::operator<(const MeasureKey& rhs) const
+{
+    // Compare the text last since that is the most expensive comparison
+    if (font != rhs.font) return font < rhs.font;
+    if (lineLength != rhs.lineLength) return lineLength < rhs.lineLength;
+    if (lineSpacing != rhs.lineSpacing) return lineSpacing < rhs.lineSpacing;
+    if (alignment != rhs.alignment) return alignment < rhs.alignment;
+    return text < rhs.text;
+}
+
+
+void
+FTGLFontManager::AddPreload(
+    const char* filename,
+    int size,
+    const std::string& glyphs)
+{
+    PreloadRequest r;
+    r.filename = filename;
+    r.size = size;
+    r.glyphs = glyphs;
+    preloadRequests_.push_back(r);
+}
+
+
+void
+FTGLFontManager::StartPreloading()
+{
+    if (IsPreloading())
+    {
+        Log::warning("FTGLFontManager", "Preloading already in progress");
+        return;
+    }
+
+    activePreloads_.swap(preloadRequests_);
+    preloadRequests_.clear();
+
+    PreloadReport report = {0, 0, 0, 0.0, 0.0};
+    preloadReport_ = report;
+    preloadStartTime_ = glfwGetTime();
+
+    // Collect the files that still need to be read
+    std::set<std::string> files;
+    for (unsigned int i = 0; i != activePreloads_.size(); ++i)
+    {
+        const std::string& f = activePreloads_[i].filename;
+        if (faceData_.find(f) == faceData_.end())
+        {
+            files.insert(f);
+        }
+    }
+
+    PreloadJob* job = new PreloadJob();
+    job->filenames.assign(files.begin(), files.end());
+    job->wm = WManager::getInstance();
+    job->done = &preloadThreadDone_;
+    preloadThreadDone_ = 0;
+
+    preloadThread_ = glfwCreateThread(preloadFonts, job);
+    if (preloadThread_ < 0)
+    {
+        Log::warning("FTGLFontManager",
+            "Could not create preload thread, loading fonts directly");
+        delete job;
+        finishPreloading();
+        return;
+    }
+
+    WManager::getInstance()->addTimer(PRELOAD_POLL_INTERVAL, this, 0);
+}
+
+
+bool
+FTGLFontManager::IsPreloading() const
+{
+    return preloadThread_ >= 0;
+}
+
+
+void
+FTGLFontManager::CancelPreloading()
+{
+    if (preloadThread_ >= 0)
+    {
+        glfwWaitThread(preloadThread_, GLFW_WAIT);
+        preloadThread_ = -1;
+        WManager::getInstance()->removeTimers(this);
+    }
+    activePreloads_.clear();
+}
+
+
+const FTGLFontManager::PreloadReport&
+FTGLFontManager::GetPreloadReport() const
+{
+    return preloadReport_;
+}
+
+
+void
+FTGLFontManager::createPreloadedFonts(
+    const std::string& filename,
+    FaceData* data)
+{
+    if (!data)
+    {
+        // Leave the requests to finishPreloading(), which reports the error
+        return;
+    }
+
+    if (faceData_.find(filename) == faceData_.end())
+    {
+        faceData_[filename] = data;
+    }
+    else
+    {
+        delete data;
+    }
+
+    double start = glfwGetTime();
+
+    std::vector<PreloadRequest>::iterator r = activePreloads_.begin();
+    while (r != activePreloads_.end())
+    {
+        if (r->filename == filename)
+        {
+            warmUp(*r);
+            r = activePreloads_.erase(r);
+        }
+        else
+        {
+            ++r;
+        }
+    }
+
+    preloadReport_.warmupTime += glfwGetTime() - start;
+}
+
+
+void
+FTGLFontManager::finishPreloading()
+{
+    if (preloadThread_ >= 0)
+    {
+        glfwWaitThread(preloadThread_, GLFW_WAIT);
+        preloadThread_ = -1;
+    }
+
+    // Create the fonts that did not get their data from the preload thread
+    // (e.g., because their file had been read in an earlier run, or a command
+    // was rejected) the usual way
+    double start = glfwGetTime();
+    for (unsigned int i = 0; i != activePreloads_.size(); ++i)
+    {
+        warmUp(activePreloads_[i]);
+    }
+    activePreloads_.clear();
+
+    double now = glfwGetTime();
+    preloadReport_.warmupTime += now - start;
+    preloadReport_.totalTime = now - preloadStartTime_;
+
+    Log::info("FTGLFontManager", Log::os() << "Preloaded "
+        << preloadReport_.fonts << " fonts with " << preloadReport_.glyphs
+        << " glyphs in " << preloadReport_.totalTime << " s ("
+        << preloadReport_.warmupTime << " s on GUI thread, "
+        << preloadReport_.failed << " failed)");
+}
+
+
+void
+FTGLFontManager::timerExpired(int /*token*/)
+{
+    if (preloadThread_ < 0)
+    {
+        return;
+    }
+
+    if (__sync_fetch_and_add(&preloadThreadDone_, 0))
+    {
+        // Commands the thread posted after this frame's commands were executed
+        // may still be pending; finishPreloading() creates their fonts directly
+        finishPreloading();
+    }
+    else
+    {
+        WManager::getInstance()->addTimer(PRELOAD_POLL_INTERVAL, this, 0);
+    }
+}
+
+
+void
+FTGLFontManager::warmUp(const PreloadRequest& r)
+{
+    float scale;
+    FTFont* font = GetRenderFont(r.filename.c_str(), r.size, scale);
+    if (font)
+    {
+        // Keep the font resident, which is the point of preloading it
+        if (preloadedFonts_.insert(font).second)
+        {
+            AcquireFont(font);
+        }
+
+        ++preloadReport_.fonts;
+        for (unsigned int i = 0; i != r.glyphs.size(); ++i)
+        {
+            // Count all bytes but UTF-8 continuation bytes
+            if ((static_cast<unsigned char>(r.glyphs[i]) & 0xC0) != 0x80)
+            {
+                ++preloadReport_.glyphs;
+            }
+        }
+        // Computing the advance creates (and uploads) the glyphs
+        font->Advance(r.glyphs.c_str());
+    }
+    else
+    {
+        ++preloadReport_.failed;
+    }
+}
+
+
 } // namespace gw1k
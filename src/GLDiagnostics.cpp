@@ -0,0 +1,267 @@
+#include "GLDiagnostics.h"
+
+#include "Log.h"
+#include "utils/StringHelpers.h"
+
+namespace gw1k
+{
+
+
+namespace
+{
+
+
+std::string
+getErrorName(GLenum err)
+{
+    switch (err)
+    {
+    case GL_INVALID_ENUM: return "GL_INVALID_ENUM";
+    case GL_INVALID_VALUE: return "GL_INVALID_VALUE";
+    case GL_INVALID_OPERATION: return "GL_INVALID_OPERATION";
+    case GL_STACK_OVERFLOW: return "GL_STACK_OVERFLOW";
+    case GL_STACK_UNDERFLOW: return "GL_STACK_UNDERFLOW";
+    case GL_OUT_OF_MEMORY: return "GL_OUT_OF_MEMORY";
+    case GL_TABLE_TOO_LARGE: return "GL_TABLE_TOO_LARGE";
+    default: return std::string("Unknown error ") + toString(err);
+    }
+}
+
+
+class SpinLock
+{
+
+public:
+
+    SpinLock(volatile int& lock)
+    :   lock_(lock)
+    {
+        while (__sync_lock_test_and_set(&lock_, 1))
+        {}
+    }
+
+    ~SpinLock()
+    {
+        __sync_lock_release(&lock_);
+    }
+
+private:
+
+    volatile int& lock_;
+
+};
+
+
+} // namespace
+
+
+/*static*/ bool GLDiagnostics::bCallbackEnabled_(false);
+
+/*static*/ const char* volatile GLDiagnostics::siteFile_(0);
+
+/*static*/ volatile int GLDiagnostics::siteLine_(0);
+
+/*static*/ std::map<GLDiagnostics::Key, GLDiagnostics::Entry>
+    GLDiagnostics::errors_;
+
+/*static*/ unsigned long GLDiagnostics::errorCount_(0);
+
+/*static*/ std::vector<std::string> GLDiagnostics::newErrors_;
+
+/*static*/ volatile int GLDiagnostics::lock_(0);
+
+
+bool
+GLDiagnostics::Key::operator<(const Key& k) const
+{
+    if (line != k.line)
+    {
+        return line < k.line;
+    }
+    return (file != k.file) ? (file < k.file) : (id < k.id);
+}
+
+
+/*static*/
+bool
+GLDiagnostics::enable(bool bSynchronous)
+{
+    // Without a debug context, many drivers don't send any messages; querying
+    // the flags fails (and leaves them 0) before OpenGL 3.0
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    glGetError();
+
+    if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT))
+    {
+        Log::info("GLDiagnostics", "No debug context, checking for errors "
+            "with glGetError()");
+        return false;
+    }
+    else if (GLEW_KHR_debug)
+    {
+        glEnable(GL_DEBUG_OUTPUT);
+        if (bSynchronous)
+        {
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        }
+        else
+        {
+            glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        }
+
+        // Notifications (e.g., about buffer placement) are not of interest
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE,
+            GL_DEBUG_SEVERITY_NOTIFICATION, 0, 0, GL_FALSE);
+        glDebugMessageCallback(messageCallback, 0);
+    }
+    else if (GLEW_ARB_debug_output)
+    {
+        if (bSynchronous)
+        {
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB);
+        }
+        else
+        {
+            glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB);
+        }
+        glDebugMessageCallbackARB(messageCallback, 0);
+    }
+    else
+    {
+        Log::info("GLDiagnostics", "No debug output extension available, "
+            "checking for errors with glGetError()");
+        return false;
+    }
+
+    bCallbackEnabled_ = true;
+    return true;
+}
+
+
+/*static*/
+bool
+GLDiagnostics::isCallbackEnabled()
+{
+    return bCallbackEnabled_;
+}
+
+
+/*static*/
+void
+GLDiagnostics::checkPoint(const char* file, int line)
+{
+    if (bCallbackEnabled_)
+    {
+        SpinLock l(lock_);
+        siteFile_ = file;
+        siteLine_ = line;
+    }
+    else
+    {
+        GLenum err = glGetError();
+        if (err != GL_NO_ERROR)
+        {
+            SpinLock l(lock_);
+            record(file, line, err, getErrorName(err));
+        }
+    }
+
+    logNewErrors();
+}
+
+
+/*static*/
+unsigned long
+GLDiagnostics::getErrorCount()
+{
+    SpinLock l(lock_);
+    return errorCount_;
+}
+
+
+/*static*/
+void
+GLDiagnostics::report()
+{
+    logNewErrors();
+
+    SpinLock l(lock_);
+    for (std::map<Key, Entry>::const_iterator i = errors_.begin();
+        i != errors_.end(); ++i)
+    {
+        const Key& k = i->first;
+        Log::error("GLDiagnostics", Log::os() << i->second.count << "x "
+            << i->second.msg << " (at " << (k.file ? k.file : "unknown site")
+            << ':' << k.line << ')');
+    }
+    errors_.clear();
+    errorCount_ = 0;
+}
+
+
+/*static*/
+void
+GLDiagnostics::record(
+    const char* file,
+    int line,
+    unsigned int id,
+    const std::string& msg)
+{
+    Key k = { file, line, id };
+    Entry& e = errors_[k];
+    ++e.count;
+    ++errorCount_;
+
+    // Only the first occurrence is logged individually; report() tells how
+    // often it happened
+    if (e.count == 1)
+    {
+        e.msg = msg;
+        newErrors_.push_back(msg + " (at " + (file ? file : "unknown site")
+            + ':' + toString(line) + ')');
+    }
+}
+
+
+/*static*/
+void
+GLDiagnostics::logNewErrors()
+{
+    std::vector<std::string> errors;
+    {
+        SpinLock l(lock_);
+        if (newErrors_.empty())
+        {
+            return;
+        }
+        errors.swap(newErrors_);
+    }
+
+    for (unsigned int i = 0; i != errors.size(); ++i)
+    {
+        Log::error("GLDiagnostics", errors[i].c_str());
+    }
+}
+
+
+/*static*/
+void GLAPIENTRY
+GLDiagnostics::messageCallback(
+    GLenum source,
+    GLenum type,
+    GLuint id,
+    GLenum severity,
+    GLsizei length,
+    const GLchar* message,
+    const void* userParam)
+{
+    if ((type == GL_DEBUG_TYPE_ERROR) || (severity == GL_DEBUG_SEVERITY_HIGH))
+    {
+        SpinLock l(lock_);
+        record(siteFile_, siteLine_, id, message);
+    }
+}
+
+
+} // namespace gw1k
@@ -3,6 +3,11 @@
 #include "WManager.h"
 #include "GLFWAdapter.h"
 #include "FTGLFontManager.h"
+#include "Log.h"
+#include "Timer.h"
+
+#include <sys/time.h>
+#include <algorithm>
 
 #define GW1K_ENABLE_GL_ERROR_CHECKS
 #include "GLErrorCheck.h"
@@ -10,9 +15,49 @@
 namespace gw1k
 {
 
+
+namespace
+{
+
+
+/** Dispatch or frame times of one kind of replayed event, in seconds */
+struct ReplayStats
+{
+    ReplayStats()
+    :   count(0),
+        total(0.),
+        max(0.)
+    {}
+
+    void add(double t)
+    {
+        ++count;
+        total += t;
+        max = std::max(max, t);
+    }
+
+    unsigned long count;
+
+    double total;
+
+    double max;
+};
+
+
+const char* const EVENT_NAMES[] = {
+    "mouse move", "mouse button", "mouse wheel", "key", "resize", "frame"
+};
+
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 /*static*/ GLFWApp* GLFWApp::pInstance_(0);
 
 GLFWApp::GLFWApp()
+:   recordingStart_(0.)
 {
     GLFWApp::pInstance_ = this;
 }
@@ -22,6 +67,12 @@ GLFWApp::GLFWApp()
 
 GLFWApp::~GLFWApp()
 {
+#ifndef NDEBUG
+    GLDiagnostics::report();
+#endif
+
+    // The preload thread posts to WManager's command queue
+    FTGLFontManager::Instance().CancelPreloading();
     WManager::cleanup();
     FTGLFontManager::Instance().cleanup();
 
@@ -71,6 +122,7 @@ GLFWApp::mainLoop()
         beforeRender();
         setupGLForRender();
         render();
+        recordInput(InputEvent::FRAME);
         glfwSwapBuffers();
         afterRender();
         running = !isMainLoopEndRequested();
@@ -82,6 +134,114 @@ GLFWApp::mainLoop()
 ////////////////////////////////////////////////////////////////////////////////
 
 
+bool
+GLFWApp::startInputRecording(const char* filename)
+{
+    if (!recorder_.open(filename))
+    {
+        return false;
+    }
+    recordingStart_ = glfwGetTime();
+
+    // Start with the current state, so the replay doesn't depend on the
+    // window size and mouse position it is started with
+    const Point& size = WManager::getInstance()->getWindowSize();
+    recordInput(InputEvent::RESIZE, size.x, size.y);
+    int x, y;
+    glfwGetMousePos(&x, &y);
+    recordInput(InputEvent::MOUSE_MOVE, x, y);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+void
+GLFWApp::stopInputRecording()
+{
+    recorder_.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+bool
+GLFWApp::replayInput(const char* filename)
+{
+    InputReplayer replayer;
+    if (!replayer.open(filename))
+    {
+        return false;
+    }
+
+    // Run timers relative to the current time, since timers already set up
+    // expire relative to it as well
+    timeval tv;
+    gettimeofday(&tv, 0);
+    const double timeBase = tv.tv_sec + tv.tv_usec * 1e-6;
+
+    ReplayStats stats[InputEvent::FRAME + 1];
+    InputEvent ev;
+    double recordedTime = 0.;
+    const double replayStart = glfwGetTime();
+
+    while (replayer.next(ev))
+    {
+        recordedTime = ev.time;
+        Timer::setVirtualTime(timeBase + ev.time);
+        double start = glfwGetTime();
+
+        switch (ev.type)
+        {
+        case InputEvent::MOUSE_MOVE:
+            mouseMoveEvent(ev.a, ev.b);
+            break;
+        case InputEvent::MOUSE_BUTTON:
+            mouseButtonEvent(ev.a, ev.b);
+            break;
+        case InputEvent::MOUSE_WHEEL:
+            mouseWheelEvent(ev.a);
+            break;
+        case InputEvent::KEY:
+            keyEvent(ev.a, ev.b);
+            break;
+        case InputEvent::RESIZE:
+            resizeWindowEvent(ev.a, ev.b);
+            break;
+        case InputEvent::FRAME:
+            beforeRender();
+            setupGLForRender();
+            render();
+            // Wait for the GPU, so the frame time includes it
+            glFinish();
+            afterRender();
+            break;
+        }
+
+        stats[ev.type].add(glfwGetTime() - start);
+    }
+
+    Timer::clearVirtualTime();
+
+    Log::info("GLFWApp", Log::os() << "Replayed " << filename << " in "
+        << (glfwGetTime() - replayStart) << " s (recorded: " << recordedTime
+        << " s)");
+    for (int i = 0; i <= InputEvent::FRAME; ++i)
+    {
+        const ReplayStats& s = stats[i];
+        if (s.count > 0)
+        {
+            Log::info("GLFWApp", Log::os() << EVENT_NAMES[i] << ": "
+                << s.count << "x, avg " << (s.total / s.count * 1e3)
+                << " ms, max " << (s.max * 1e3) << " ms");
+        }
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 void
 GLFWApp::preMainLoop()
 {}
@@ -105,14 +265,11 @@ GLFWApp::setupGLForRender()
     // http://www.opengl.org/resources/features/KilgardTechniques/oglpitfall/
     // and
     // http://www.opengl.org/wiki/Viewing_and_Transformations
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
     const Point& size = WManager::getInstance()->getWindowSize();
-    glOrtho(0, size.x, size.y, 0, -1, 1);
+    setOrthoProjection(0, size.x, size.y, 0);
     //gluOrtho2D(0, winSize_.x, 0, winSize_.y);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glTranslatef(0.375f, 0.375f, 0.f);
+    loadIdentityTransform();
+    translateTransform(0.375f, 0.375f);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -180,6 +337,15 @@ GLFWApp::getWindowParams(int& r, int& g, int& b, int& a, int& depthBits, int& st
 ////////////////////////////////////////////////////////////////////////////////
 
 
+RenderPath
+GLFWApp::getPreferredRenderPath()
+{
+    return GW1K_RENDER_FIXED_FUNCTION;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 void
 GLFWApp::resizeWindowEvent(int width, int height)
 {
@@ -245,6 +411,21 @@ GLFWApp::setupGLFW()
         return 1;
     }
 
+    // Load the entry points of GL extensions (e.g., buffer objects); widgets
+    // check for the extensions they use and fall back to plain GL otherwise
+    if (glewInit() != GLEW_OK)
+    {
+        Log::warning("GLFWApp", "GLEW could not be initialised");
+    }
+
+#ifndef NDEBUG
+    // Report GL errors through the driver's debug output if possible, so
+    // error checks don't stall rendering
+    GLDiagnostics::enable();
+#endif
+
+    setRenderPath(getPreferredRenderPath());
+
     registerGLFWCallbacks();
 
     // Set vsync on
@@ -273,10 +454,24 @@ GLFWApp::registerGLFWCallbacks()
 ////////////////////////////////////////////////////////////////////////////////
 
 
+void
+GLFWApp::recordInput(InputEvent::Type type, int a, int b)
+{
+    if (recorder_.isOpen())
+    {
+        recorder_.record(
+            InputEvent(type, glfwGetTime() - recordingStart_, a, b));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 /*static*/
 void
 GLFWApp::resizeWindowCallback(int width, int height)
 {
+    pInstance_->recordInput(InputEvent::RESIZE, width, height);
     pInstance_->resizeWindowEvent(width, height);
 }
 
@@ -287,6 +482,7 @@ GLFWApp::resizeWindowCallback(int width, int height)
 void
 GLFWApp::keyCallback(int key, int event)
 {
+    pInstance_->recordInput(InputEvent::KEY, key, event);
     pInstance_->keyEvent(key, event);
 }
 
@@ -297,6 +493,7 @@ GLFWApp::keyCallback(int key, int event)
 void
 GLFWApp::mousePosCallback(int x, int y)
 {
+    pInstance_->recordInput(InputEvent::MOUSE_MOVE, x, y);
     pInstance_->mouseMoveEvent(x, y);
 }
 
@@ -307,6 +504,7 @@ GLFWApp::mousePosCallback(int x, int y)
 void
 GLFWApp::mouseButtonCallback(int identifier, int event)
 {
+    pInstance_->recordInput(InputEvent::MOUSE_BUTTON, identifier, event);
     pInstance_->mouseButtonEvent(identifier, event);
 }
 
@@ -317,6 +515,7 @@ GLFWApp::mouseButtonCallback(int identifier, int event)
 void
 GLFWApp::mouseWheelCallback(int pos)
 {
+    pInstance_->recordInput(InputEvent::MOUSE_WHEEL, pos);
     pInstance_->mouseWheelEvent(pos);
 }
 
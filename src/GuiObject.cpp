@@ -2,10 +2,13 @@
 
 
 #include "WManager.h"
+#include "layouts/Layout.h"
+#include "MemoryReport.h"
 #include "MathHelper.h"
 #include "utils/Helpers.h"
 #include "Exception.h"
 #include "Log.h"
+#include <algorithm>
 #include <iostream>
 #include <limits>
 
@@ -40,6 +43,8 @@ GuiObject::GuiObject()
     dragAreaPadding_(0, 0),
     bIsInteractive_(true),
     bIsClickThrough_(false),
+    bIsFocusable_(false),
+    bIsFocused_(false),
     dragArea_(0),
     dragChecker_(0),
     bIsResizeable_(false),
@@ -47,7 +52,12 @@ GuiObject::GuiObject()
     resizeFrameTopLeft_(3, 3),
     resizeFrameBottomRight_(3, 3),
     minSize_(6, 6),
-    maxSize_(std::numeric_limits<int>::max(), std::numeric_limits<int>::max())
+    maxSize_(std::numeric_limits<int>::max(), std::numeric_limits<int>::max()),
+    subObjIndex_(-1),
+    layout_(0),
+    stretch_(0.f),
+    bLayoutDirty_(false),
+    bApplyingLayout_(false)
 {}
 
 
@@ -56,6 +66,7 @@ GuiObject::~GuiObject()
     MSG("~GuiObject: " << (void*) this);
 
     DELETE_PTR(dragArea_);
+    DELETE_PTR(layout_);
 
     // Make sure subobjects don't reference this GuiObject when it is already
     // deleted
@@ -120,6 +131,8 @@ GuiObject::setPos(float x, float y)
 const Point&
 GuiObject::setSize(float width, float height)
 {
+    Point oldSize = rect_.size();
+
     if (parent_)
     {
         const Point& parSize = parent_->rect_.size();
@@ -145,6 +158,18 @@ GuiObject::setSize(float width, float height)
 
     rect_.size(round_pos(width), round_pos(height));
 
+    if (rect_.size() != oldSize)
+    {
+        invalidateLayout();
+
+        // The parent's layout may depend on this object's size (e.g., items
+        // without stretch keep their size), unless it set the size itself
+        if (parent_ && !parent_->bApplyingLayout_)
+        {
+            parent_->invalidateLayout();
+        }
+    }
+
     return rect_.size();
 }
 
@@ -225,7 +250,14 @@ GuiObject::setClicked(bool state)
 void
 GuiObject::setVisible(bool state)
 {
-    bIsVisible_ = state;
+    if (state != bIsVisible_)
+    {
+        bIsVisible_ = state;
+        if (parent_)
+        {
+            parent_->invalidateLayout();
+        }
+    }
 }
 
 
@@ -267,6 +299,54 @@ GuiObject::isClickThrough() const
 }
 
 
+void
+GuiObject::setFocusable(bool state)
+{
+    bIsFocusable_ = state;
+}
+
+
+bool
+GuiObject::isFocusable() const
+{
+    return bIsFocusable_;
+}
+
+
+void
+GuiObject::setFocused(bool state)
+{
+    bIsFocused_ = state;
+}
+
+
+bool
+GuiObject::isFocused() const
+{
+    return bIsFocused_;
+}
+
+
+void
+GuiObject::collectFocusableObjects(std::vector<GuiObject*>& v)
+{
+    if (!bIsVisible_ || !bIsInteractive_)
+    {
+        return;
+    }
+
+    if (bIsFocusable_)
+    {
+        v.push_back(this);
+    }
+
+    for (unsigned int i = 0; i != subObjects_.size(); ++i)
+    {
+        subObjects_[i]->collectFocusableObjects(v);
+    }
+}
+
+
 void
 GuiObject::triggerMouseMovedEvent(
     MouseMovedEvent ev, const Point& pos, const Point& delta)
@@ -286,6 +366,14 @@ GuiObject::triggerMouseMovedEvent(
 }
 
 
+void
+GuiObject::triggerMouseHoveredEvent(const Point& pos, const Point& delta)
+{
+    bIsHovered_ = true;
+    informMouseListenersHovered(pos, delta, this);
+}
+
+
 void
 GuiObject::triggerMouseButtonEvent(MouseButton b, StateEvent ev)
 {
@@ -323,6 +411,13 @@ GuiObject::triggerMouseWheelEvent(int delta)
 }
 
 
+void
+GuiObject::triggerKeyEvent(int key, StateEvent ev)
+{
+    informKeyListeners(key, ev, this);
+}
+
+
 void
 GuiObject::triggerDraggedEvent(const Point& delta)
 {
@@ -354,27 +449,22 @@ GuiObject::addSubObject(GuiObject* o)
         o->parent_ = this;
     }
 
+    o->subObjIndex_ = subObjects_.size();
     subObjects_.push_back(o);
+    invalidateLayout();
 }
 
 
 void
 GuiObject::removeSubObject(GuiObject* o)
 {
-    for (std::vector<GuiObject*>::iterator i = subObjects_.begin();
-        i != subObjects_.end(); ++i)
+    if (holdsSubObject(o))
     {
-        if (*i == o)
-        {
-            subObjects_.erase(i);
-            o->parent_ = 0;
-            if (o->bContainsMouse_)
-            {
-                o->bContainsMouse_ = false;
-                o->resetSubObjContainsMouseStatus();
-            }
-            return;
-        }
+        subObjects_.erase(subObjects_.begin() + o->subObjIndex_);
+        updateSubObjIndices(o->subObjIndex_);
+        detachSubObject(o);
+        invalidateLayout();
+        return;
     }
     Log::warning("GuiObject", Log::os()
         << "Attempt to remove sub-object " << (void*)o
@@ -382,6 +472,83 @@ GuiObject::removeSubObject(GuiObject* o)
 }
 
 
+void
+GuiObject::removeSubObjects(const std::vector<GuiObject*>& objects)
+{
+    // Mark the objects' slots, then compact the list in one pass
+    std::vector<bool> bRemove(subObjects_.size(), false);
+    for (unsigned int i = 0; i != objects.size(); ++i)
+    {
+        GuiObject* o = objects[i];
+        if (holdsSubObject(o))
+        {
+            bRemove[o->subObjIndex_] = true;
+        }
+        else
+        {
+            Log::warning("GuiObject", Log::os()
+                << "Attempt to remove sub-object " << (void*)o
+                << ", but couldn't be found in sub-object list");
+        }
+    }
+
+    unsigned int n = 0;
+    for (unsigned int i = 0; i != subObjects_.size(); ++i)
+    {
+        GuiObject* o = subObjects_[i];
+        if (bRemove[i])
+        {
+            detachSubObject(o);
+        }
+        else
+        {
+            o->subObjIndex_ = n;
+            subObjects_[n++] = o;
+        }
+    }
+
+    if (n != subObjects_.size())
+    {
+        subObjects_.resize(n);
+        invalidateLayout();
+    }
+}
+
+
+void
+GuiObject::removeAndDeleteSubObjects(const std::vector<GuiObject*>& objects)
+{
+    // Only objects that are sub-objects of some object now and are detached
+    // by removeSubObjects() are deleted (overrides may remove them from other
+    // objects, e.g., ScrollPane's pane); each object is deleted once
+    std::vector<GuiObject*> attached;
+    attached.reserve(objects.size());
+    for (unsigned int i = 0; i != objects.size(); ++i)
+    {
+        if (objects[i] && (objects[i]->subObjIndex_ >= 0))
+        {
+            attached.push_back(objects[i]);
+        }
+    }
+    std::sort(attached.begin(), attached.end());
+    attached.erase(std::unique(attached.begin(), attached.end()),
+        attached.end());
+
+    WManager* wm = WManager::getInstance();
+    wm->beginRemovalBatch();
+    removeSubObjects(objects);
+    for (unsigned int i = 0; i != attached.size(); ++i)
+    {
+        // Objects that weren't removed are left alone
+        if (attached[i]->subObjIndex_ < 0)
+        {
+            delete attached[i];
+        }
+    }
+    wm->endRemovalBatch();
+}
+
+
 void
 GuiObject::removeAndDeleteSubObject(GuiObject* o)
 {
@@ -396,11 +563,15 @@ GuiObject::removeAndDeleteSubObject(GuiObject* o)
 void
 GuiObject::removeAndDeleteAllSubObjects()
 {
+    WManager* wm = WManager::getInstance();
+    wm->beginRemovalBatch();
     for (unsigned int i = 0; i != subObjects_.size(); ++i)
     {
+        subObjects_[i]->subObjIndex_ = -1;
         delete subObjects_[i];
     }
     subObjects_.clear();
+    wm->endRemovalBatch();
 }
 
 
@@ -716,6 +887,17 @@ void
 GuiObject::setMinSize(const Point& minSize)
 {
     minSize_ = minSize;
+    if (parent_)
+    {
+        parent_->invalidateLayout();
+    }
+}
+
+
+const Point&
+GuiObject::getMinSize() const
+{
+    return minSize_;
 }
 
 
@@ -723,6 +905,86 @@ void
 GuiObject::setMaxSize(const Point& maxSize)
 {
     maxSize_ = maxSize;
+    if (parent_)
+    {
+        parent_->invalidateLayout();
+    }
+}
+
+
+const Point&
+GuiObject::getMaxSize() const
+{
+    return maxSize_;
+}
+
+
+void
+GuiObject::setLayout(Layout* layout)
+{
+    if (layout_)
+    {
+        layout_->container_ = 0;
+        delete layout_;
+    }
+    layout_ = layout;
+    if (layout_)
+    {
+        layout_->container_ = this;
+        invalidateLayout();
+    }
+}
+
+
+Layout*
+GuiObject::getLayout() const
+{
+    return layout_;
+}
+
+
+void
+GuiObject::setStretch(float stretch)
+{
+    stretch_ = stretch;
+    if (parent_)
+    {
+        parent_->invalidateLayout();
+    }
+}
+
+
+float
+GuiObject::getStretch() const
+{
+    return stretch_;
+}
+
+
+void
+GuiObject::invalidateLayout()
+{
+    if (layout_ && !bLayoutDirty_)
+    {
+        bLayoutDirty_ = true;
+        WManager::getInstance()->scheduleLayout(this);
+    }
+}
+
+
+void
+GuiObject::updateLayout()
+{
+    if (bLayoutDirty_)
+    {
+        bLayoutDirty_ = false;
+        if (layout_)
+        {
+            bApplyingLayout_ = true;
+            layout_->apply(this);
+            bApplyingLayout_ = false;
+        }
+    }
 }
 
 
@@ -736,6 +998,20 @@ GuiObject::setResizeFrame(int top, int left, int bottom, int right)
 }
 
 
+void
+GuiObject::accountMemory(MemoryFootprint& f) const
+{
+    f.object = sizeof(*this);
+    f.listeners += getHeapSize(subObjects_) + getHeapSize(mouseListeners_)
+        + getHeapSize(hoverListeners_) + getHeapSize(keyListeners_)
+        + getHeapSize(draggedListeners_) + getHeapSize(resizedListeners_);
+    if (dragArea_)
+    {
+        f.buffers += sizeof(Rect);
+    }
+}
+
+
 void
 GuiObject::checkDragDelta(
     Point& delta,
@@ -764,20 +1040,47 @@ GuiObject::resetSubObjContainsMouseStatus()
 void
 GuiObject::moveOnTop(GuiObject* newTopSubObj)
 {
-    std::vector<GuiObject*>::iterator i = subObjects_.begin();
-    unsigned int c = 0;
-    for (; (*i != newTopSubObj) && (i != subObjects_.end()); ++i)
-    {
-        ++c;
-    }
-
-    if (i != subObjects_.end())
+    if (holdsSubObject(newTopSubObj))
     {
+        unsigned int c = newTopSubObj->subObjIndex_;
         for (; c < subObjects_.size() - 1; ++c)
         {
             subObjects_[c] = subObjects_[c + 1];
         }
         subObjects_[c] = newTopSubObj;
+        updateSubObjIndices(newTopSubObj->subObjIndex_);
+    }
+}
+
+
+bool
+GuiObject::holdsSubObject(const GuiObject* o) const
+{
+    int i = o->subObjIndex_;
+    return (i >= 0) && (i < static_cast<int>(subObjects_.size()))
+        && (subObjects_[i] == o);
+}
+
+
+void
+GuiObject::updateSubObjIndices(unsigned int from)
+{
+    for (unsigned int i = from; i < subObjects_.size(); ++i)
+    {
+        subObjects_[i]->subObjIndex_ = i;
+    }
+}
+
+
+void
+GuiObject::detachSubObject(GuiObject* o)
+{
+    o->subObjIndex_ = -1;
+    o->parent_ = 0;
+    if (o->bContainsMouse_)
+    {
+        o->bContainsMouse_ = false;
+        o->resetSubObjContainsMouseStatus();
     }
 }
 
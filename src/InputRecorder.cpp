@@ -0,0 +1,228 @@
+#include "InputRecorder.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace gw1k
+{
+
+
+namespace
+{
+
+
+const char MAGIC[] = "GW1KINPT";
+
+const int MAGIC_SIZE = 8;
+
+const char VERSION = 1;
+
+
+} // namespace
+
+
+InputEvent::InputEvent(Type type, double time, int a, int b)
+:   type(type),
+    time(time),
+    a(a),
+    b(b)
+{}
+
+
+InputRecorder::InputRecorder()
+:   lastTime_(0.)
+{}
+
+
+InputRecorder::~InputRecorder()
+{
+    close();
+}
+
+
+bool
+InputRecorder::open(const char* filename)
+{
+    close();
+    file_.clear();
+    file_.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file_)
+    {
+        Log::error("InputRecorder", Log::os() << "Cannot write " << filename);
+        return false;
+    }
+
+    file_.write(MAGIC, MAGIC_SIZE);
+    file_.put(VERSION);
+    lastTime_ = 0.;
+    return true;
+}
+
+
+void
+InputRecorder::close()
+{
+    if (file_.is_open())
+    {
+        file_.close();
+    }
+}
+
+
+bool
+InputRecorder::isOpen() const
+{
+    return file_.is_open();
+}
+
+
+void
+InputRecorder::record(const InputEvent& ev)
+{
+    if (!file_.is_open())
+    {
+        return;
+    }
+
+    double t = std::floor(ev.time * 1e6 + .5);
+    double delta = std::max(0., t - lastTime_);
+    lastTime_ += delta;
+
+    file_.put(static_cast<char>(ev.type));
+    writeNumber(static_cast<unsigned long>(delta));
+    switch (ev.type)
+    {
+    case InputEvent::FRAME:
+        break;
+    case InputEvent::MOUSE_WHEEL:
+        writeSigned(ev.a);
+        break;
+    default:
+        writeSigned(ev.a);
+        writeSigned(ev.b);
+    }
+}
+
+
+void
+InputRecorder::writeNumber(unsigned long v)
+{
+    // Seven bits per byte, least significant first; the high bit marks that
+    // more bytes follow
+    while (v >= 0x80)
+    {
+        file_.put(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    file_.put(static_cast<char>(v));
+}
+
+
+void
+InputRecorder::writeSigned(int v)
+{
+    // Interleave negative and positive values, so small magnitudes stay small
+    unsigned int u = static_cast<unsigned int>(v);
+    writeNumber((u << 1) ^ (v < 0 ? ~0u : 0u));
+}
+
+
+InputReplayer::InputReplayer()
+:   lastTime_(0.)
+{}
+
+
+bool
+InputReplayer::open(const char* filename)
+{
+    if (file_.is_open())
+    {
+        file_.close();
+    }
+    file_.clear();
+    file_.open(filename, std::ios::in | std::ios::binary);
+
+    char header[MAGIC_SIZE + 1];
+    if (!file_ || !file_.read(header, MAGIC_SIZE + 1)
+        || (std::memcmp(header, MAGIC, MAGIC_SIZE) != 0))
+    {
+        Log::error("InputReplayer", Log::os() << filename
+            << " is not an input recording");
+        return false;
+    }
+    if (header[MAGIC_SIZE] != VERSION)
+    {
+        Log::error("InputReplayer", Log::os() << filename
+            << " has unsupported version " << int(header[MAGIC_SIZE]));
+        return false;
+    }
+
+    lastTime_ = 0.;
+    return true;
+}
+
+
+bool
+InputReplayer::next(InputEvent& ev)
+{
+    int type = file_.get();
+    unsigned long delta;
+    if ((type < InputEvent::MOUSE_MOVE) || (type > InputEvent::FRAME)
+        || !readNumber(delta))
+    {
+        return false;
+    }
+
+    lastTime_ += delta;
+    ev = InputEvent(static_cast<InputEvent::Type>(type), lastTime_ * 1e-6);
+    switch (ev.type)
+    {
+    case InputEvent::FRAME:
+        return true;
+    case InputEvent::MOUSE_WHEEL:
+        return readSigned(ev.a);
+    default:
+        return readSigned(ev.a) && readSigned(ev.b);
+    }
+}
+
+
+bool
+InputReplayer::readNumber(unsigned long& v)
+{
+    v = 0;
+    for (unsigned int shift = 0; shift < 8 * sizeof(v); shift += 7)
+    {
+        int c = file_.get();
+        if (c == std::char_traits<char>::eof())
+        {
+            return false;
+        }
+        v |= static_cast<unsigned long>(c & 0x7f) << shift;
+        if (!(c & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool
+InputReplayer::readSigned(int& v)
+{
+    unsigned long u;
+    if (!readNumber(u))
+    {
+        return false;
+    }
+    unsigned int w = static_cast<unsigned int>(u);
+    v = static_cast<int>((w >> 1) ^ (w & 1 ? ~0u : 0u));
+    return true;
+}
+
+
+} // namespace gw1k
@@ -0,0 +1,185 @@
+#include "MemoryReport.h"
+
+#include "GuiObject.h"
+#include "ColorTable.h"
+#include "Log.h"
+
+#include <cstdlib>
+#include <typeinfo>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+namespace gw1k
+{
+
+
+MemoryFootprint::MemoryFootprint()
+:   object(0),
+    colors(0),
+    listeners(0),
+    text(0),
+    buffers(0),
+    gpu(0)
+{}
+
+
+MemoryFootprint&
+MemoryFootprint::operator+=(const MemoryFootprint& f)
+{
+    object += f.object;
+    colors += f.colors;
+    listeners += f.listeners;
+    text += f.text;
+    buffers += f.buffers;
+    gpu += f.gpu;
+    fonts.insert(f.fonts.begin(), f.fonts.end());
+    return *this;
+}
+
+
+std::size_t
+MemoryFootprint::getHostTotal() const
+{
+    return object + colors + listeners + text + buffers;
+}
+
+
+void
+MemoryFootprint::addColors(const ColorTable& ct)
+{
+    const Color4i* cols[] = { ct.fgCol, ct.bgCol, ct.hoveredFgCol,
+        ct.hoveredBgCol, ct.clickedFgCol, ct.clickedBgCol };
+    for (unsigned int i = 0; i != sizeof(cols) / sizeof(cols[0]); ++i)
+    {
+        if (cols[i])
+        {
+            colors += sizeof(Color4i);
+        }
+    }
+}
+
+
+MemoryReport::Entry::Entry()
+:   count(0)
+{}
+
+
+void
+MemoryReport::add(const GuiObject* o)
+{
+    add(o, 0, 0, 0);
+}
+
+
+void
+MemoryReport::clear()
+{
+    entries_.clear();
+}
+
+
+const std::map<std::string, MemoryReport::Entry>&
+MemoryReport::getEntries() const
+{
+    return entries_;
+}
+
+
+MemoryReport::Entry
+MemoryReport::getTotal() const
+{
+    Entry total;
+    for (std::map<std::string, Entry>::const_iterator i = entries_.begin();
+        i != entries_.end(); ++i)
+    {
+        total.count += i->second.count;
+        total.footprint += i->second.footprint;
+    }
+    return total;
+}
+
+
+void
+MemoryReport::log(unsigned int perWidgets) const
+{
+    Entry total = getTotal();
+    for (std::map<std::string, Entry>::const_iterator i = entries_.begin();
+        i != entries_.end(); ++i)
+    {
+        const Entry& e = i->second;
+        const MemoryFootprint& f = e.footprint;
+        double scale = perWidgets ? double(perWidgets) / e.count : 1.;
+        Log::info("MemoryReport", Log::os() << i->first << " ("
+            << (perWidgets ? perWidgets : e.count) << "x): "
+            << std::size_t(f.getHostTotal() * scale) << " bytes [object "
+            << std::size_t(f.object * scale) << ", colors "
+            << std::size_t(f.colors * scale) << ", listeners "
+            << std::size_t(f.listeners * scale) << ", text "
+            << std::size_t(f.text * scale) << ", buffers "
+            << std::size_t(f.buffers * scale) << "], GPU "
+            << std::size_t(f.gpu * scale) << " bytes, "
+            << f.fonts.size() << " fonts");
+    }
+    Log::info("MemoryReport", Log::os() << "Total (" << total.count
+        << " widgets): " << total.footprint.getHostTotal() << " bytes, GPU "
+        << total.footprint.gpu << " bytes, " << total.footprint.fonts.size()
+        << " fonts");
+}
+
+
+/*static*/
+std::string
+MemoryReport::getClassName(const GuiObject* o)
+{
+    const char* name = typeid(*o).name();
+#ifdef __GNUG__
+    int status;
+    char* demangled = abi::__cxa_demangle(name, 0, 0, &status);
+    if (demangled)
+    {
+        std::string s(demangled);
+        std::free(demangled);
+        return s;
+    }
+#endif
+    return name;
+}
+
+
+void
+MemoryReport::add(
+    const GuiObject* o,
+    Entry* owner,
+    const char* ownerBegin,
+    const char* ownerEnd)
+{
+    MemoryFootprint f;
+    o->accountMemory(f);
+
+    // Members are part of the object containing them, so their own size has
+    // already been counted
+    const char* begin = static_cast<const char*>(dynamic_cast<const void*>(o));
+    Entry* e;
+    if (owner && (begin >= ownerBegin) && (begin < ownerEnd))
+    {
+        f.object = 0;
+        e = owner;
+    }
+    else
+    {
+        e = &entries_[getClassName(o)];
+        ++e->count;
+        ownerBegin = begin;
+        ownerEnd = begin + f.object;
+    }
+    e->footprint += f;
+
+    for (unsigned int i = 0; i != o->subObjects_.size(); ++i)
+    {
+        add(o->subObjects_[i], e, ownerBegin, ownerEnd);
+    }
+}
+
+
+} // namespace gw1k
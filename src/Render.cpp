@@ -1,6 +1,12 @@
 #include "Render.h"
 
+#include "RenderPipeline.h"
+#include "utils/ShaderHelpers.h"
+
+#include <algorithm>
 #include <cmath>
+#include <map>
+#include <vector>
 #include <GL/glew.h>
 
 //#define GW1K_ENABLE_GL_ERROR_CHECKS
@@ -14,33 +20,318 @@ const double pi = std::atan(1.) * 4.;
 
 struct P2 { float x, y; };
 
-P2* circles[3] = { 0, 0, 0 };
+typedef std::map<int, std::vector<P2> > CircleMap;
+
+/** Unit circles by number of segments */
+CircleMap circles;
+
 int circleSizes[3] = { 50, 200, 1000 };
 
-void setupCircle(int idx)
+/** Maximum deviation of the tessellated from the real outline, in pixels */
+const float MAX_ELLIPSE_ERROR = 0.25f;
+
+const int MIN_ELLIPSE_SEGMENTS = 8;
+
+const int MAX_ELLIPSE_SEGMENTS = 1024;
+
+/** Vertices of the current batch (x, y pairs) */
+std::vector<float> batch;
+
+
+const std::vector<P2>& getCircle(int segments)
 {
-    P2* a = new P2[circleSizes[idx]];
+    std::vector<P2>& a = circles[segments];
+    if (a.empty())
+    {
+        a.resize(segments);
+        double dt = 2. * pi / segments;
+        for (int i = 0; i != segments; ++i)
+        {
+            a[i].x = std::cos(i * dt);
+            a[i].y = std::sin(i * dt);
+        }
+    }
+    return a;
+}
 
-    float t = 0.f;
-    float dt = 2. * pi / circleSizes[idx];
 
-    for (int i = 0; i != circleSizes[idx]; ++i, t += dt)
+/**
+ * Gets the number of pixels per unit along x and y for ellipses of the given
+ * size index; the modelview matrix is only queried (which is a round trip to
+ * the GL on the fixed-function path) for ELLIPSE_ADAPTIVE. Batches query this
+ * once for all their ellipses.
+ */
+geom::Point2D getPixelScale(int sizeIdx)
+{
+    if (sizeIdx != gw1k::ELLIPSE_ADAPTIVE)
     {
-        a[i].x = std::cos(t);
-        a[i].y = std::sin(t);
+        return geom::Point2D(1.f, 1.f);
     }
 
-    circles[idx] = a;
+    // The projection maps to window pixels, so the modelview's scale is the
+    // number of pixels per unit
+    GLfloat m[16];
+    gw1k::getModelviewMatrix(m);
+    return geom::Point2D(std::sqrt(m[0] * m[0] + m[1] * m[1]),
+        std::sqrt(m[4] * m[4] + m[5] * m[5]));
 }
 
-P2* getCircle(int idx, int& size)
+
+/**
+ * Gets the number of segments for an ellipse with the given radius: either one
+ * of the fixed sizes, or, if sizeIdx is ELLIPSE_ADAPTIVE, as many as needed so
+ * the outline deviates by at most MAX_ELLIPSE_ERROR pixels on screen (rounded
+ * up to a multiple of 8, so only a few circles are cached). pxScale is the
+ * result of getPixelScale().
+ */
+int getEllipseSegments(
+    const geom::Point2D& radius,
+    int sizeIdx,
+    const geom::Point2D& pxScale)
 {
-    if (!circles[idx])
+    if (sizeIdx != gw1k::ELLIPSE_ADAPTIVE)
+    {
+        return circleSizes[sizeIdx];
+    }
+
+    float r = std::max(std::abs(radius.x) * pxScale.x,
+        std::abs(radius.y) * pxScale.y);
+
+    int segments = MIN_ELLIPSE_SEGMENTS;
+    if (r > MAX_ELLIPSE_ERROR)
     {
-        setupCircle(idx);
+        double angle = std::acos(1. - MAX_ELLIPSE_ERROR / r);
+        segments = static_cast<int>(std::ceil(pi / angle));
+    }
+    segments = (segments + 7) / 8 * 8;
+    return std::max(MIN_ELLIPSE_SEGMENTS,
+        std::min(MAX_ELLIPSE_SEGMENTS, segments));
+}
+
+
+void addVertex(float x, float y)
+{
+    batch.push_back(x);
+    batch.push_back(y);
+}
+
+
+/**
+ * Adds the triangles of a filled ellipse to the batch.
+ */
+void addEllipseTriangles(
+    const geom::Point2D& center,
+    const geom::Point2D& radius,
+    int sizeIdx,
+    const geom::Point2D& pxScale)
+{
+    const std::vector<P2>& a =
+        getCircle(getEllipseSegments(radius, sizeIdx, pxScale));
+    int size = a.size();
+    for (int i = 0; i != size; ++i)
+    {
+        const P2& p = a[i];
+        const P2& q = a[(i + 1) % size];
+        addVertex(center.x, center.y);
+        addVertex(center.x + radius.x * p.x, center.y + radius.y * p.y);
+        addVertex(center.x + radius.x * q.x, center.y + radius.y * q.y);
+    }
+}
+
+
+/**
+ * Draws the batch with the given mode and clears it.
+ */
+void drawBatch(GLenum mode)
+{
+    if (!batch.empty())
+    {
+        gw1k::drawVertices(mode, &batch[0], batch.size() / 2);
+        batch.clear();
+    }
+}
+
+
+/**
+ * Draws the outline of an ellipse.
+ */
+void drawEllipseOutline(
+    const geom::Point2D& center,
+    const geom::Point2D& radius,
+    int sizeIdx)
+{
+    const std::vector<P2>& a = getCircle(
+        getEllipseSegments(radius, sizeIdx, getPixelScale(sizeIdx)));
+    for (unsigned int i = 0; i != a.size(); ++i)
+    {
+        addVertex(center.x + radius.x * a[i].x, center.y + radius.y * a[i].y);
+    }
+    drawBatch(GL_LINE_LOOP);
+}
+
+
+const char* STYLED_VERTEX_SHADER =
+    "uniform mat4 transform;\n"
+    "attribute vec2 position;\n"
+    "attribute vec4 boxAttrib;\n"
+    "attribute vec2 shapeAttrib;\n"
+    "attribute vec4 borderColorAttrib;\n"
+    "attribute vec4 fillColorAttrib;\n"
+    "varying vec4 box;\n"
+    "varying vec2 shape;\n"
+    "varying vec4 borderColor;\n"
+    "varying vec4 fillColor;\n"
+    "void main()\n"
+    "{\n"
+    "    box = boxAttrib;\n"
+    "    shape = shapeAttrib;\n"
+    "    borderColor = borderColorAttrib;\n"
+    "    fillColor = fillColorAttrib;\n"
+    "    gl_Position = transform * vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+
+// Evaluates the signed distance to the rounded box's outline (negative inside)
+// and covers the outer borderWidth pixels with the border colour; both edges
+// are anti-aliased over one pixel
+const char* STYLED_FRAGMENT_SHADER =
+    "#ifdef GL_ES\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "varying vec4 box;\n"
+    "varying vec2 shape;\n"
+    "varying vec4 borderColor;\n"
+    "varying vec4 fillColor;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 q = abs(box.xy) - box.zw + shape.x;\n"
+    "    float d = min(max(q.x, q.y), 0.0) + length(max(q, 0.0)) - shape.x;\n"
+    "    float outer = clamp(0.5 - d, 0.0, 1.0);\n"
+    "    float inner = clamp(0.5 - d - shape.y, 0.0, 1.0);\n"
+    "    vec4 c = mix(borderColor, fillColor, outer > 0.0 ? inner / outer : 1.0);\n"
+    "    gl_FragColor = vec4(c.rgb, c.a * outer);\n"
+    "}\n";
+
+
+/**
+ * Per-vertex data of styled rectangles: position, position relative to the
+ * centre and half size, corner radius and border width, border colour, and
+ * fill colour
+ */
+const int STYLED_VERTEX_SIZE = 16;
+
+/** Vertices of the current batch of styled rectangles */
+std::vector<float> styledBatch;
+
+/** Names, sizes and offsets of the styled vertex attributes */
+const char* STYLED_ATTRIB_NAMES[] = { "position", "boxAttrib", "shapeAttrib",
+    "borderColorAttrib", "fillColorAttrib" };
+
+const int STYLED_ATTRIB_SIZES[] = { 2, 4, 2, 4, 4 };
+
+const int STYLED_ATTRIB_OFFSETS[] = { 0, 2, 6, 8, 12 };
+
+const int NUM_STYLED_ATTRIBS = 5;
+
+GLuint styledProgram = 0;
+
+GLint styledAttribs[NUM_STYLED_ATTRIBS];
+
+GLint styledTransform = -1;
+
+bool bStyledProgramCreated = false;
+
+
+void addColor(std::vector<float>& v, const gw1k::Color4i& c)
+{
+    v.push_back(c.rf);
+    v.push_back(c.gf);
+    v.push_back(c.bf);
+    v.push_back(c.af);
+}
+
+
+void addStyledVertex(
+    float x,
+    float y,
+    const geom::Point2D& center,
+    const geom::Point2D& halfSize,
+    float radius,
+    float borderWidth,
+    const gw1k::Color4i& border,
+    const gw1k::Color4i& fill)
+{
+    styledBatch.push_back(x);
+    styledBatch.push_back(y);
+    styledBatch.push_back(x - center.x);
+    styledBatch.push_back(y - center.y);
+    styledBatch.push_back(halfSize.x);
+    styledBatch.push_back(halfSize.y);
+    styledBatch.push_back(radius);
+    styledBatch.push_back(borderWidth);
+    addColor(styledBatch, border);
+    addColor(styledBatch, fill);
+}
+
+
+/**
+ * Adds the two triangles of a styled rectangle to the batch.
+ */
+void addStyledRect(
+    const geom::Point2D& p0,
+    const geom::Point2D& p1,
+    const gw1k::BoxStyle& style)
+{
+    geom::Point2D center((p0.x + p1.x) * .5f, (p0.y + p1.y) * .5f);
+    geom::Point2D halfSize(
+        std::abs(p1.x - p0.x) * .5f, std::abs(p1.y - p0.y) * .5f);
+    float radius = std::max(0.f,
+        std::min(style.cornerRadius, std::min(halfSize.x, halfSize.y)));
+
+    // Without a border colour, there is no border; without a fill colour, the
+    // fill is a transparent border colour, so the border's inner edge doesn't
+    // fade to black
+    const gw1k::Color4i transparent(0, 0, 0, 0);
+    const gw1k::Color4i* border = style.borderColor;
+    float borderWidth = border ? std::max(0.f, style.borderWidth) : 0.f;
+    gw1k::Color4i top(transparent);
+    gw1k::Color4i bottom(transparent);
+    if (style.fillColor)
+    {
+        top = *style.fillColor;
+        bottom = style.gradientColor ? *style.gradientColor : top;
+    }
+    else if (border)
+    {
+        top = bottom = border->alpha(0);
+    }
+    const gw1k::Color4i& b = border ? *border : transparent;
+
+    float y0 = std::min(p0.y, p1.y);
+    float y1 = std::max(p0.y, p1.y);
+    addStyledVertex(p0.x, y0, center, halfSize, radius, borderWidth, b, top);
+    addStyledVertex(p1.x, y0, center, halfSize, radius, borderWidth, b, top);
+    addStyledVertex(p1.x, y1, center, halfSize, radius, borderWidth, b, bottom);
+    addStyledVertex(p0.x, y0, center, halfSize, radius, borderWidth, b, top);
+    addStyledVertex(p1.x, y1, center, halfSize, radius, borderWidth, b, bottom);
+    addStyledVertex(p0.x, y1, center, halfSize, radius, borderWidth, b, bottom);
+}
+
+
+void createStyledProgram()
+{
+    bStyledProgramCreated = true;
+    styledProgram = gw1k::createShaderProgram(STYLED_VERTEX_SHADER,
+        STYLED_FRAGMENT_SHADER, "Render");
+    if (styledProgram)
+    {
+        for (int i = 0; i != NUM_STYLED_ATTRIBS; ++i)
+        {
+            styledAttribs[i] =
+                glGetAttribLocation(styledProgram, STYLED_ATTRIB_NAMES[i]);
+        }
+        styledTransform = glGetUniformLocation(styledProgram, "transform");
     }
-    size = circleSizes[idx];
-    return circles[idx];
 }
 
 
@@ -68,14 +359,11 @@ void drawRect(
     const geom::Point2D& p2,
     const geom::Point2D& p3)
 {
-    glBegin(GL_LINE_LOOP);
-    {
-        glVertex3f(p0.x, p0.y, 0.f);
-        glVertex3f(p1.x, p1.y, 0.f);
-        glVertex3f(p2.x, p2.y, 0.f);
-        glVertex3f(p3.x, p3.y, 0.f);
-    }
-    glEnd();
+    addVertex(p0.x, p0.y);
+    addVertex(p1.x, p1.y);
+    addVertex(p2.x, p2.y);
+    addVertex(p3.x, p3.y);
+    drawBatch(GL_LINE_LOOP);
 }
 
 
@@ -95,14 +383,12 @@ void fillRect(
     const geom::Point2D& p2,
     const geom::Point2D& p3)
 {
-    glBegin(GL_QUADS);
-    {
-        glVertex3f(p0.x, p0.y, 0.f);
-        glVertex3f(p1.x, p1.y, 0.f);
-        glVertex3f(p2.x, p2.y, 0.f);
-        glVertex3f(p3.x, p3.y, 0.f);
-    }
-    glEnd();
+    // A fan instead of GL_QUADS, which core profiles don't have
+    addVertex(p0.x, p0.y);
+    addVertex(p1.x, p1.y);
+    addVertex(p2.x, p2.y);
+    addVertex(p3.x, p3.y);
+    drawBatch(GL_TRIANGLE_FAN);
 }
 
 
@@ -111,18 +397,10 @@ void drawTriangle(
     const geom::Point2D& p1,
     const geom::Point2D& p2)
 {
-    glBegin(GL_LINES);
-    {
-        glVertex3f(p0.x, p0.y, 0.f);
-        glVertex3f(p1.x, p1.y, 0.f);
-
-        glVertex3f(p1.x, p1.y, 0.f);
-        glVertex3f(p2.x, p2.y, 0.f);
-
-        glVertex3f(p2.x, p2.y, 0.f);
-        glVertex3f(p0.x, p0.y, 0.f);
-    }
-    glEnd();
+    addVertex(p0.x, p0.y);
+    addVertex(p1.x, p1.y);
+    addVertex(p2.x, p2.y);
+    drawBatch(GL_LINE_LOOP);
 }
 
 
@@ -132,13 +410,10 @@ fillTriangle(
     const geom::Point2D& p1,
     const geom::Point2D& p2)
 {
-    glBegin(GL_TRIANGLES);
-    {
-        glVertex3f(p0.x, p0.y, 0.f);
-        glVertex3f(p1.x, p1.y, 0.f);
-        glVertex3f(p2.x, p2.y, 0.f);
-    }
-    glEnd();
+    addVertex(p0.x, p0.y);
+    addVertex(p1.x, p1.y);
+    addVertex(p2.x, p2.y);
+    drawBatch(GL_TRIANGLES);
 }
 
 
@@ -147,57 +422,191 @@ void drawEllipse(
     const geom::Point2D& radius,
     int sizeIdx)
 {
-    glPushMatrix();
-    {
-        int size;
-        P2* a = getCircle(sizeIdx, size);
+    drawEllipseOutline(center, radius, sizeIdx);
+}
 
-        glTranslatef(center.x, center.y, 0.f);
-        glScalef(radius.x, radius.y, 1.f);
 
-        glBegin(GL_LINE_LOOP);
-        {
-            for (int i = 0; i != size; ++i)
-            {
-                glVertex2f(a[i].x, a[i].y);
-            }
-        }
-        glEnd();
+void fillEllipse(
+    const geom::Point2D& center,
+    const geom::Point2D& radius,
+    int sizeIdx)
+{
+    // The fan's centre, each outline vertex once, and the first one again to
+    // close the fan
+    const std::vector<P2>& a = getCircle(
+        getEllipseSegments(radius, sizeIdx, getPixelScale(sizeIdx)));
+    addVertex(center.x, center.y);
+    for (unsigned int i = 0; i != a.size(); ++i)
+    {
+        addVertex(center.x + radius.x * a[i].x, center.y + radius.y * a[i].y);
     }
-    glPopMatrix();
+    addVertex(center.x + radius.x * a[0].x, center.y + radius.y * a[0].y);
+    drawBatch(GL_TRIANGLE_FAN);
 }
 
 
-void fillEllipse(
+void drawEllipseSmooth(
     const geom::Point2D& center,
     const geom::Point2D& radius,
     int sizeIdx)
 {
-    glPushMatrix();
+    glPushAttrib(GL_LINE_BIT | GL_HINT_BIT);
+    glEnable(GL_LINE_SMOOTH);
+    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    drawEllipseOutline(center, radius, sizeIdx);
+    glPopAttrib();
+}
+
+
+void fillEllipseSmooth(
+    const geom::Point2D& center,
+    const geom::Point2D& radius,
+    int sizeIdx)
+{
+    // Polygon smoothing is not widely supported, so the edge of the fill is
+    // covered with a smooth outline instead
+    fillEllipse(center, radius, sizeIdx);
+    drawEllipseSmooth(center, radius, sizeIdx);
+}
+
+
+void fillEllipses(
+    const geom::Point2D* centers,
+    const geom::Point2D* radii,
+    int n,
+    int sizeIdx)
+{
+    geom::Point2D pxScale = getPixelScale(sizeIdx);
+    for (int i = 0; i != n; ++i)
     {
-        int size;
-        P2* a = getCircle(sizeIdx, size);
+        addEllipseTriangles(centers[i], radii[i], sizeIdx, pxScale);
+    }
+    drawBatch(GL_TRIANGLES);
+}
 
-        glTranslatef(center.x, center.y, 0.f);
-        glScalef(radius.x, radius.y, 1.f);
 
+void fillRects(const geom::Point2D* corners, int n)
+{
+    for (int i = 0; i != n; ++i)
+    {
+        const geom::Point2D& p0 = corners[2 * i];
+        const geom::Point2D& p1 = corners[2 * i + 1];
+        addVertex(p0.x, p0.y);
+        addVertex(p1.x, p0.y);
+        addVertex(p1.x, p1.y);
+        addVertex(p0.x, p0.y);
+        addVertex(p1.x, p1.y);
+        addVertex(p0.x, p1.y);
+    }
+    drawBatch(GL_TRIANGLES);
+}
 
-        glBegin(GL_TRIANGLE_FAN);
-        {
-            glVertex2f(0.f, 0.f);
 
-            for (int i = 0; i != size - 1; ++i)
+void fillTriangles(const geom::Point2D* points, int n)
+{
+    for (int i = 0; i != 3 * n; ++i)
+    {
+        addVertex(points[i].x, points[i].y);
+    }
+    drawBatch(GL_TRIANGLES);
+}
+
+
+BoxStyle::BoxStyle()
+:   cornerRadius(0.f),
+    borderWidth(1.f),
+    fillColor(0),
+    gradientColor(0),
+    borderColor(0)
+{}
+
+
+void drawStyledRect(
+    const geom::Point2D& p0,
+    const geom::Point2D& p1,
+    const BoxStyle& style)
+{
+    geom::Point2D corners[2] = { p0, p1 };
+    drawStyledRects(corners, &style, 1);
+}
+
+
+void drawStyledRects(const geom::Point2D* corners, const BoxStyle* styles, int n)
+{
+    if (!bStyledProgramCreated)
+    {
+        createStyledProgram();
+    }
+
+    for (int i = 0; i != n; ++i)
+    {
+        addStyledRect(corners[2 * i], corners[2 * i + 1], styles[i]);
+    }
+    if (styledBatch.empty())
+    {
+        return;
+    }
+
+    int numVertices = styledBatch.size() / STYLED_VERTEX_SIZE;
+    if (styledProgram)
+    {
+        float t[16];
+        getTransformMatrix(t);
+        glUseProgram(styledProgram);
+        glUniformMatrix4fv(styledTransform, 1, GL_FALSE, t);
+
+        const float* base = streamVertices(&styledBatch[0], styledBatch.size());
+        for (int i = 0; i != NUM_STYLED_ATTRIBS; ++i)
+        {
+            if (styledAttribs[i] >= 0)
             {
-                glVertex2f(a[i].x, a[i].y);
-                glVertex2f(a[i+1].x, a[i+1].y);
+                glEnableVertexAttribArray(styledAttribs[i]);
+                glVertexAttribPointer(styledAttribs[i], STYLED_ATTRIB_SIZES[i],
+                    GL_FLOAT, GL_FALSE, STYLED_VERTEX_SIZE * sizeof(float),
+                    base + STYLED_ATTRIB_OFFSETS[i]);
             }
+        }
 
-            glVertex2f(a[size - 1].x, a[size - 1].y);
-            glVertex2f(a[0].x, a[0].y);
+        glDrawArrays(GL_TRIANGLES, 0, numVertices);
+
+        for (int i = 0; i != NUM_STYLED_ATTRIBS; ++i)
+        {
+            if (styledAttribs[i] >= 0)
+            {
+                glDisableVertexAttribArray(styledAttribs[i]);
+            }
         }
-        glEnd();
+        releaseVertices();
+        glUseProgram(0);
     }
-    glPopMatrix();
+    else
+    {
+        // Without shaders, corners stay square and borders are one pixel wide,
+        // but gradients still work through vertex colours
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, STYLED_VERTEX_SIZE * sizeof(float),
+            &styledBatch[0]);
+        glColorPointer(4, GL_FLOAT, STYLED_VERTEX_SIZE * sizeof(float),
+            &styledBatch[12]);
+        glDrawArrays(GL_TRIANGLES, 0, numVertices);
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+
+        for (int i = 0; i != n; ++i)
+        {
+            const Color4i* border = styles[i].borderColor;
+            if (border && (styles[i].borderWidth > 0.f))
+            {
+                const geom::Point2D& p0 = corners[2 * i];
+                const geom::Point2D& p1 = corners[2 * i + 1];
+                setGLColor(border);
+                drawRect(p0, geom::Point2D(p1.x - 1.f, p1.y - 1.f));
+            }
+        }
+    }
+
+    styledBatch.clear();
 }
 
 
@@ -208,6 +617,7 @@ setGLColor(const Color4i* c)
     // colours are not set up correctly
     if (c) {
         glColor4f(c->rf, c->gf, c->bf, c->af);
+        setDrawColor(*c);
     }
 }
 
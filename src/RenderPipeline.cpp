@@ -0,0 +1,372 @@
+#include "RenderPipeline.h"
+
+#include "utils/ShaderHelpers.h"
+#include "Log.h"
+
+#include <cstring>
+#include <vector>
+
+
+namespace
+{
+
+
+struct Matrix
+{
+    /** Column-major, as used by OpenGL */
+    float m[16];
+};
+
+
+// Valid GLSL for OpenGL 2.0 compatibility contexts and for OpenGL ES 2.0
+const char* VERTEX_SHADER =
+    "uniform mat4 transform;\n"
+    "attribute vec2 position;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = transform * vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+
+const char* FRAGMENT_SHADER =
+    "#ifdef GL_ES\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "uniform vec4 color;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_FragColor = color;\n"
+    "}\n";
+
+
+Matrix identity()
+{
+    Matrix a;
+    std::memset(a.m, 0, sizeof(a.m));
+    a.m[0] = a.m[5] = a.m[10] = a.m[15] = 1.f;
+    return a;
+}
+
+
+/**
+ * Sets r to a * b.
+ */
+void multiply(const float* a, const float* b, float* r)
+{
+    for (int col = 0; col != 4; ++col)
+    {
+        for (int row = 0; row != 4; ++row)
+        {
+            float sum = 0.f;
+            for (int k = 0; k != 4; ++k)
+            {
+                sum += a[k * 4 + row] * b[col * 4 + k];
+            }
+            r[col * 4 + row] = sum;
+        }
+    }
+}
+
+
+gw1k::RenderPath renderPath = gw1k::GW1K_RENDER_FIXED_FUNCTION;
+
+/** Projection of the shader path */
+Matrix projection = identity();
+
+/** Modelview stack of the shader path; the current transform is the last one */
+std::vector<Matrix> modelview(1, identity());
+
+/**
+ * Whether OpenGL's matrix stack differs from the shader path's transforms, see
+ * syncFixedFunctionTransform()
+ */
+bool bFixedFunctionStale = true;
+
+GLuint program = 0;
+
+GLint transformUniform = -1;
+
+GLint colorUniform = -1;
+
+GLint positionAttrib = -1;
+
+float drawColor[4] = { 1.f, 1.f, 1.f, 1.f };
+
+/** Buffer object that vertices are streamed through on the shader path */
+GLuint streamVbo = 0;
+
+
+bool createProgram()
+{
+    program = gw1k::createShaderProgram(VERTEX_SHADER, FRAGMENT_SHADER,
+        "RenderPipeline");
+    if (!program)
+    {
+        return false;
+    }
+
+    transformUniform = glGetUniformLocation(program, "transform");
+    colorUniform = glGetUniformLocation(program, "color");
+    positionAttrib = glGetAttribLocation(program, "position");
+    glGenBuffers(1, &streamVbo);
+    return true;
+}
+
+
+} // namespace
+
+
+namespace gw1k
+{
+
+
+bool
+setRenderPath(RenderPath path)
+{
+    if ((path == GW1K_RENDER_SHADERS) && !program && !createProgram())
+    {
+        Log::warning("RenderPipeline", "Shaders are not available, staying on "
+            "the fixed-function render path");
+        renderPath = GW1K_RENDER_FIXED_FUNCTION;
+        return false;
+    }
+
+    renderPath = path;
+    bFixedFunctionStale = true;
+    return true;
+}
+
+
+RenderPath
+getRenderPath()
+{
+    return renderPath;
+}
+
+
+void
+setOrthoProjection(float left, float right, float bottom, float top)
+{
+    if (renderPath == GW1K_RENDER_FIXED_FUNCTION)
+    {
+        glMatrixMode(GL_PROJECTION);
+        glLoadIdentity();
+        glOrtho(left, right, bottom, top, -1., 1.);
+        glMatrixMode(GL_MODELVIEW);
+        return;
+    }
+
+    projection = identity();
+    float* m = projection.m;
+    m[0] = 2.f / (right - left);
+    m[5] = 2.f / (top - bottom);
+    m[10] = -1.f;
+    m[12] = -(right + left) / (right - left);
+    m[13] = -(top + bottom) / (top - bottom);
+    bFixedFunctionStale = true;
+}
+
+
+void
+loadIdentityTransform()
+{
+    if (renderPath == GW1K_RENDER_FIXED_FUNCTION)
+    {
+        glLoadIdentity();
+        return;
+    }
+
+    modelview.back() = identity();
+    bFixedFunctionStale = true;
+}
+
+
+void
+pushTransform()
+{
+    if (renderPath == GW1K_RENDER_FIXED_FUNCTION)
+    {
+        glPushMatrix();
+        return;
+    }
+
+    Matrix top = modelview.back();
+    modelview.push_back(top);
+}
+
+
+void
+popTransform()
+{
+    if (renderPath == GW1K_RENDER_FIXED_FUNCTION)
+    {
+        glPopMatrix();
+        return;
+    }
+
+    if (modelview.size() > 1)
+    {
+        modelview.pop_back();
+        bFixedFunctionStale = true;
+    }
+    else
+    {
+        Log::warning("RenderPipeline", "popTransform() without matching "
+            "pushTransform()");
+    }
+}
+
+
+void
+translateTransform(float x, float y)
+{
+    if (renderPath == GW1K_RENDER_FIXED_FUNCTION)
+    {
+        glTranslatef(x, y, 0.f);
+        return;
+    }
+
+    float* m = modelview.back().m;
+    for (int row = 0; row != 4; ++row)
+    {
+        m[12 + row] += m[row] * x + m[4 + row] * y;
+    }
+    bFixedFunctionStale = true;
+}
+
+
+void
+scaleTransform(float x, float y)
+{
+    if (renderPath == GW1K_RENDER_FIXED_FUNCTION)
+    {
+        glScalef(x, y, 1.f);
+        return;
+    }
+
+    float* m = modelview.back().m;
+    for (int row = 0; row != 4; ++row)
+    {
+        m[row] *= x;
+        m[4 + row] *= y;
+    }
+    bFixedFunctionStale = true;
+}
+
+
+void
+getModelviewMatrix(float* m)
+{
+    if (renderPath == GW1K_RENDER_FIXED_FUNCTION)
+    {
+        glGetFloatv(GL_MODELVIEW_MATRIX, m);
+    }
+    else
+    {
+        std::memcpy(m, modelview.back().m, sizeof(Matrix().m));
+    }
+}
+
+
+void
+getTransformMatrix(float* m)
+{
+    if (renderPath == GW1K_RENDER_FIXED_FUNCTION)
+    {
+        float p[16], mv[16];
+        glGetFloatv(GL_PROJECTION_MATRIX, p);
+        glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+        multiply(p, mv, m);
+    }
+    else
+    {
+        multiply(projection.m, modelview.back().m, m);
+    }
+}
+
+
+void
+syncFixedFunctionTransform()
+{
+    if ((renderPath == GW1K_RENDER_SHADERS) && bFixedFunctionStale)
+    {
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(projection.m);
+        glMatrixMode(GL_MODELVIEW);
+        glLoadMatrixf(modelview.back().m);
+        bFixedFunctionStale = false;
+    }
+}
+
+
+void
+setDrawColor(const Color4i& c)
+{
+    drawColor[0] = c.rf;
+    drawColor[1] = c.gf;
+    drawColor[2] = c.bf;
+    drawColor[3] = c.af;
+}
+
+
+void
+drawVertices(GLenum mode, const float* xy, int n)
+{
+    if (n == 0)
+    {
+        return;
+    }
+
+    if (renderPath == GW1K_RENDER_FIXED_FUNCTION)
+    {
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glVertexPointer(2, GL_FLOAT, 0, xy);
+        glDrawArrays(mode, 0, n);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        return;
+    }
+
+    float t[16];
+    getTransformMatrix(t);
+    glUseProgram(program);
+    glUniformMatrix4fv(transformUniform, 1, GL_FALSE, t);
+    glUniform4fv(colorUniform, 1, drawColor);
+
+    const float* p = streamVertices(xy, 2 * n);
+    glEnableVertexAttribArray(positionAttrib);
+    glVertexAttribPointer(positionAttrib, 2, GL_FLOAT, GL_FALSE, 0, p);
+    glDrawArrays(mode, 0, n);
+    glDisableVertexAttribArray(positionAttrib);
+    releaseVertices();
+
+    glUseProgram(0);
+}
+
+
+const float*
+streamVertices(const float* data, int n)
+{
+    if (renderPath == GW1K_RENDER_FIXED_FUNCTION)
+    {
+        return data;
+    }
+
+    // Respecifying the whole store lets the driver hand out fresh memory
+    // instead of waiting for draws still reading the previous data
+    glBindBuffer(GL_ARRAY_BUFFER, streamVbo);
+    glBufferData(GL_ARRAY_BUFFER, n * sizeof(float), data, GL_STREAM_DRAW);
+    return 0;
+}
+
+
+void
+releaseVertices()
+{
+    if (renderPath == GW1K_RENDER_SHADERS)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+
+} // namespace gw1k
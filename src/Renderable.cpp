@@ -3,7 +3,9 @@
 #include <GL/glew.h>
 
 #include "utils/Helpers.h"
+#include "Render.h"
 #include "ThemeManager.h"
+#include "MemoryReport.h"
 
 //#define GW1K_ENABLE_GL_ERROR_CHECKS
 #include "gw1k/include/GLErrorCheck.h"
@@ -113,7 +115,7 @@ Renderable::renderSelf(const Point& offset) const
 
     if (bg)
     {
-        glColor4f(bg->rf, bg->gf, bg->bf, bg->af);
+        setGLColor(bg);
         renderBg(offset);
     }
 
@@ -121,7 +123,7 @@ Renderable::renderSelf(const Point& offset) const
 
     if (fg)
     {
-        glColor4f(fg->rf, fg->gf, fg->bf, fg->af);
+        setGLColor(fg);
         renderFg(offset);
     }
 }
@@ -164,4 +166,20 @@ Renderable::selectColors(Color4i*& fg, Color4i*& bg) const
 }
 
 
+const ColorTable&
+Renderable::getColorTable() const
+{
+    return colorTable_;
+}
+
+
+void
+Renderable::accountMemory(MemoryFootprint& f) const
+{
+    GuiObject::accountMemory(f);
+    f.object = sizeof(*this);
+    f.addColors(colorTable_);
+}
+
+
 } // namespace gw1k
@@ -27,7 +27,8 @@ ThemeManager::getInstance()
 
 
 ThemeManager::ThemeManager()
-:   l_(0)
+:   l_(0),
+    bLookupsSuspended_(false)
 {}
 
 
@@ -88,6 +89,11 @@ ThemeManager::setColors(
     const char* colorScheme,
     const char* fallbackScheme) const
 {
+    if (bLookupsSuspended_)
+    {
+        return;
+    }
+
     r->setFgColor(getFgColor(colorScheme, fallbackScheme));
     r->setBgColor(getBgColor(colorScheme, fallbackScheme));
     r->setHoveredFgColor(getHoveredFgColor(colorScheme, fallbackScheme));
@@ -103,6 +109,11 @@ ThemeManager::setColors(
     const char* colorScheme,
     const char* fallbackScheme) const
 {
+    if (bLookupsSuspended_)
+    {
+        return;
+    }
+
     setColor(getFgColor(colorScheme, fallbackScheme), ct.fgCol);
     setColor(getBgColor(colorScheme, fallbackScheme), ct.bgCol);
     setColor(getHoveredFgColor(colorScheme, fallbackScheme), ct.hoveredFgCol);
@@ -203,6 +214,44 @@ ThemeManager::getColor(
 }
 
 
+float
+ThemeManager::getStyleValue(
+    const char* property,
+    const char* colorScheme,
+    const char* fallbackScheme,
+    float defaultValue) const
+{
+    const char* scheme = (colorScheme ? colorScheme : fallbackScheme);
+
+    if ((scheme != 0) && !bLookupsSuspended_)
+    {
+        std::string key(scheme);
+        key.append(".").append(property);
+
+        std::map<std::string, float>::const_iterator it = styleMap_.find(key);
+        return (it != styleMap_.end()) ? it->second : defaultValue;
+    }
+    else
+    {
+        return defaultValue;
+    }
+}
+
+
+void
+ThemeManager::setLookupsSuspended(bool state)
+{
+    bLookupsSuspended_ = state;
+}
+
+
+bool
+ThemeManager::areLookupsSuspended() const
+{
+    return bLookupsSuspended_;
+}
+
+
 bool
 ThemeManager::loadLua()
 {
@@ -240,6 +289,18 @@ ThemeManager::readTheme()
     // contain the new key and value
     while (lua_next(l_, -2) != 0)
     {
+        // Style properties are plain numbers
+        if (lua_type(l_, -1) == LUA_TNUMBER)
+        {
+            float value = lua_tonumber(l_, -1);
+            lua_pop(l_, 1);
+            std::string key = lua_tostring(l_, -1);
+            styleMap_[key] = value;
+            Log::info("ThemeManager", Log::os() << "Added " << key << " = "
+                << value);
+            continue;
+        }
+
         int rgba[4];
 
         // Top of the stack is a Color object of our Lua Color class, push
@@ -7,6 +7,11 @@ namespace gw1k
 {
 
 
+/*static*/ bool Timer::bVirtualTime_(false);
+
+/*static*/ timeval Timer::virtualTime_;
+
+
 Timer::Timer(double seconds, TimerListener* target, int token)
 :   target(target),
     token(token)
@@ -25,7 +30,7 @@ bool
 Timer::expired() const
 {
     timeval now;
-    gettimeofday(&now, 0);
+    getTime(now);
     return expired(now);
 }
 
@@ -41,14 +46,14 @@ void
 Timer::newTimeout(double seconds)
 {
     timeval now;
-    gettimeofday(&now, 0);
+    getTime(now);
 
     tvEnd_.tv_sec = now.tv_sec + std::floor(seconds);
     double intpart;
     tvEnd_.tv_usec = now.tv_usec + std::modf(seconds, &intpart) * 1e6;
-    if (tvEnd_.tv_usec >= 10e6)
+    if (tvEnd_.tv_usec >= 1000000)
     {
-        tvEnd_.tv_usec -= 10e6;
+        tvEnd_.tv_usec -= 1000000;
         tvEnd_.tv_sec += 1;
     }
 }
@@ -111,4 +116,38 @@ Timer::operator>=(const timeval& time) const
 }
 
 
+/*static*/
+void
+Timer::getTime(timeval& now)
+{
+    if (bVirtualTime_)
+    {
+        now = virtualTime_;
+    }
+    else
+    {
+        gettimeofday(&now, 0);
+    }
+}
+
+
+/*static*/
+void
+Timer::setVirtualTime(double seconds)
+{
+    double intpart;
+    virtualTime_.tv_usec = std::modf(seconds, &intpart) * 1e6;
+    virtualTime_.tv_sec = intpart;
+    bVirtualTime_ = true;
+}
+
+
+/*static*/
+void
+Timer::clearVirtualTime()
+{
+    bVirtualTime_ = false;
+}
+
+
 } // namespace gw1k
@@ -4,7 +4,9 @@
 
 #include <GL/glew.h>
 
+#include <algorithm>
 #include <iostream>
+#include <utility>
 #include <sys/time.h>
 
 //#define MSG(x) std::cout << x << std::endl
@@ -14,6 +16,43 @@
 #include "GLErrorCheck.h"
 
 
+namespace
+{
+
+
+/** Key codes are within [0, NUM_KEY_CODES), see gw1k::KeyCode */
+const int NUM_KEY_CODES = gw1k::GW1K_KEY_F12 + 1;
+
+/** Number of combinations of the KeyModifier flags */
+const int NUM_MODIFIER_COMBINATIONS = 8;
+
+
+const int MODKEY_LSHIFT = 1;
+const int MODKEY_RSHIFT = 2;
+const int MODKEY_LCTRL = 4;
+const int MODKEY_RCTRL = 8;
+const int MODKEY_LALT = 16;
+const int MODKEY_RALT = 32;
+
+
+int getModifierKeyBit(int key)
+{
+    switch (key)
+    {
+    case gw1k::GW1K_KEY_LSHIFT: return MODKEY_LSHIFT;
+    case gw1k::GW1K_KEY_RSHIFT: return MODKEY_RSHIFT;
+    case gw1k::GW1K_KEY_LCTRL: return MODKEY_LCTRL;
+    case gw1k::GW1K_KEY_RCTRL: return MODKEY_RCTRL;
+    case gw1k::GW1K_KEY_LALT: return MODKEY_LALT;
+    case gw1k::GW1K_KEY_RALT: return MODKEY_RALT;
+    default: return 0;
+    }
+}
+
+
+} // namespace
+
+
 namespace gw1k
 {
 
@@ -44,7 +83,16 @@ WManager::cleanup()
 WManager::WManager()
 :   hoveredObj_(0),
     clickedObj_(0),
-    mainWin_(new Box(Point(), Point()))
+    mainWin_(new Box(Point(), Point())),
+    bWindowResizePending_(false),
+    bFrameRendered_(false),
+    focusedObj_(0),
+    bTabFocusTraversal_(true),
+    pressedModifierKeys_(0),
+    shortcuts_(NUM_KEY_CODES * NUM_MODIFIER_COMBINATIONS,
+        static_cast<KeyListener*>(0)),
+    removalBatchDepth_(0),
+    bHoverLost_(false)
 {}
 
 
@@ -83,21 +131,7 @@ WManager::feedMouseMoveInternal(const Point& pos, const Point& delta, GuiObject*
             o = mainWin_->getContainingObject(pos);
         }
 
-        //GuiObject* prevHoveredObj = hoveredObj_;
-
-        // Trigger Mouse-Left event for element that was previously hovered, but
-        // is not anymore (because the mouse totally left the object, or is
-        // hovering a sub-object now, or the object moved/disappeared)
-        if (hoveredObj_ != o)
-        {
-            //MSG("WManager::feedMouseMoveInternal: hoveredObj_ = " << (void*)hoveredObj_ << ", o = " << (void*)o << ", setting hoveredObj_ to o " << (void*)o);
-            feedMouseMoveHandleOldHoveredObj(pos, delta, o);
-            hoveredObj_ = o;
-        }
-
-        // Trigger Mouse-Hovered or Mouse-Entered event for element that is
-        // currently hovered
-        feedMouseMoveHandleNewHoveredObj(pos, delta);
+        updateHoverPath(o, pos, delta);
     }
 
     //MSG("WManager::feedMouseMoveInternal [end]");
@@ -148,85 +182,57 @@ WManager::feedMouseMoveInternal_handleClickedObj(
 
 
 void
-WManager::feedMouseMoveHandleOldHoveredObj(
-    const Point& pos,
-    const Point& delta,
-    const GuiObject* newHoveredObj) const
+WManager::updateHoverPath(GuiObject* o, const Point& pos, const Point& delta)
 {
-    if (!hoveredObj_)
+    // The path of o: its first non-embedded parent (or o itself) first, o last
+    newHoverPath_.clear();
+    for (GuiObject* p = o; p; p = p->isEmbedded() ? p->getParent() : 0)
     {
-        return;
+        newHoverPath_.push_back(p);
     }
+    std::reverse(newHoverPath_.begin(), newHoverPath_.end());
 
-    if (hoveredObj_->isEmbedded())
+    unsigned int common = 0;
+    while ((common < hoverPath_.size()) && (common < newHoverPath_.size())
+        && (hoverPath_[common] == newHoverPath_[common]))
     {
-        hoveredObj_->triggerMouseMovedEvent(GW1K_M_LEFT, pos, delta);
+        ++common;
+    }
 
-        // Check which embedded parents have been left as well and trigger event
-        // for them. After the loop, hPar will point to the non-embedded parent.
-        GuiObject* hPar = hoveredObj_->getParent();
-        while (hPar->isEmbedded())
-        {
-            hPar->triggerMouseMovedEvent(
-                hPar->containsMouse() ? GW1K_M_HOVERED : GW1K_M_LEFT, pos, delta);
-            hPar = hPar->getParent();
-        }
+    // Copy the left objects, since listeners may remove objects, which
+    // changes the hover path
+    std::vector<GuiObject*> left;
+    if (common < hoverPath_.size())
+    {
+        left.assign(hoverPath_.begin() + common, hoverPath_.end());
+    }
+    std::swap(hoverPath_, newHoverPath_);
+    hoveredObj_ = o;
 
-        GuiObject* nPar = 0;
-        if (newHoveredObj && newHoveredObj->isEmbedded())
+    // Objects only on the old path have been left, innermost first
+    for (unsigned int i = left.size(); i > 0; --i)
+    {
+        MSG("WManager::updateHoverPath: left " << (void*)left[i - 1]);
+        left[i - 1]->triggerMouseMovedEvent(GW1K_M_LEFT, pos, delta);
+    }
+
+    // Objects only on the new path have been entered; the others are still
+    // hovered. Stop if a listener's removal of an object changed the path.
+    for (unsigned int i = hoverPath_.size(); i > 0; --i)
+    {
+        if ((hoveredObj_ != o) || (i > hoverPath_.size()))
         {
-            nPar = newHoveredObj->getNonEmbeddedParent();
+            break;
         }
 
-        // Check if the containing non-embedded parent is also left; this is
-        // either true if there is no new hovered object, or if the new
-        // hovered object is not embedded (but has the same parent), or when
-        // it is embedded, but in another parent
-        if (!newHoveredObj || (hPar != nPar))
+        GuiObject* p = hoverPath_[i - 1];
+        if (i > common)
         {
-            hPar->triggerMouseMovedEvent(GW1K_M_LEFT, pos, delta);
+            p->triggerMouseMovedEvent(GW1K_M_ENTERED, pos, delta);
         }
         else
         {
-            hPar->triggerMouseMovedEvent(GW1K_M_HOVERED, pos, delta);
-        }
-    }
-    else // hoveredObj_ NOT embedded
-    {
-        // If new hovered object is an embedded sub-object of hoveredObj_,
-        // do nothing (that is, no LEFT event), otherwise trigger LEFT event
-        bool bIsEmbeddedSubObj = newHoveredObj && newHoveredObj->isEmbedded()
-            && (newHoveredObj->getNonEmbeddedParent() == hoveredObj_);
-        if (!bIsEmbeddedSubObj)
-        {
-            hoveredObj_->triggerMouseMovedEvent(GW1K_M_LEFT, pos, delta);
-        }
-    }
-}
-
-
-void
-WManager::feedMouseMoveHandleNewHoveredObj(
-    const Point& pos,
-    const Point& delta) const
-{
-    if (hoveredObj_)
-    {
-        hoveredObj_->triggerMouseMovedEvent(
-            hoveredObj_->isHovered() ? GW1K_M_HOVERED : GW1K_M_ENTERED, pos,
-            delta);
-
-        if (hoveredObj_->isEmbedded())
-        {
-            // Trigger events for all embedded parents and first non-embedded
-            // parent
-            GuiObject* p = hoveredObj_->getParent();
-            while (p)
-            {
-                p->triggerMouseMovedEvent(
-                    p->isHovered() ? GW1K_M_HOVERED : GW1K_M_ENTERED, pos, delta);
-                p = p->isEmbedded() ? p->getParent() : 0;
-            }
+            p->triggerMouseHoveredEvent(pos, delta);
         }
     }
 }
@@ -275,6 +281,11 @@ WManager::feedMouseClick(MouseButton b, StateEvent ev)
         feedMouseMoveInternal(mousePos_, Point(0, 0), currHoveredObj);
     }
 
+    if (ev == GW1K_PRESSED)
+    {
+        updateFocusOnClick(currHoveredObj);
+    }
+
     // Trigger event for object that is currently hovered (only that can
     // possibly be the receiver of mouse clicks)
     if (!eventHandled && currHoveredObj)
@@ -306,7 +317,42 @@ WManager::feedMouseClick(MouseButton b, StateEvent ev)
 void
 WManager::feedKey(int key, StateEvent ev)
 {
+    updateModifierKeys(key, ev);
+
+    if (ev == GW1K_PRESSED)
+    {
+        // Global shortcuts take precedence over the focused object
+        int idx = getShortcutIndex(key, getKeyModifiers());
+        if ((idx >= 0) && shortcuts_[idx])
+        {
+            shortcuts_[idx]->keyEvent(key, ev, focusedObj_);
+            return;
+        }
+
+        if (bTabFocusTraversal_ && (key == GW1K_KEY_TAB))
+        {
+            moveFocus((getKeyModifiers() & GW1K_MOD_SHIFT) ? -1 : 1);
+            return;
+        }
+    }
+
+    if (focusedObj_)
+    {
+        focusedObj_->triggerKeyEvent(key, ev);
 
+        // Note that focusedObj_ may have been reset in the triggered method in
+        // case the focused object has been removed
+        if (focusedObj_ && focusedObj_->isEmbedded())
+        {
+            // Trigger event for all embedded parents and first non-embedded one
+            GuiObject* p = focusedObj_->getParent();
+            while (p)
+            {
+                p->triggerKeyEvent(key, ev);
+                p = p->isEmbedded() ? p->getParent() : 0;
+            }
+        }
+    }
 }
 
 
@@ -340,7 +386,14 @@ WManager::setWindowSize(int width, int height)
 {
     winSize_.x = width;
     winSize_.y = height;
-    mainWin_->setSize(width, height);
+    if (bFrameRendered_)
+    {
+        bWindowResizePending_ = true;
+    }
+    else
+    {
+        mainWin_->setSize(winSize_.x, winSize_.y);
+    }
 }
 
 
@@ -400,24 +453,51 @@ WManager::popGlScissorOffset()
 }
 
 
+const Point&
+WManager::getGlScissorOffset() const
+{
+    return scissorStack_.getGlScissorOffset();
+}
+
+
+void
+WManager::pushGlScissorOrigin(const Point& origin)
+{
+    scissorStack_.pushGlScissorOrigin(origin);
+}
+
+
+void
+WManager::popGlScissorOrigin()
+{
+    scissorStack_.popGlScissorOrigin();
+}
+
+
 void
 WManager::render()
 {
     //MSG("WManager::render()");
 
+    bFrameRendered_ = true;
+
+    // Apply updates posted by other threads first so they take effect in this
+    // frame
+    commandQueue_.execute();
+
     checkTimers();
 
-    for (std::list<GuiObject*>::iterator i = preRenderDeleteQueue_.begin();
-        i != preRenderDeleteQueue_.end(); ++i)
+    processDeleteQueue();
+
+    // Propagate only the last window size set since the previous frame; the
+    // layouts depending on it are then applied in the same frame
+    if (bWindowResizePending_)
     {
-        GuiObject* p = (*i)->getParent();
-        if (p)
-        {
-            p->removeSubObject(*i);
-        }
-        delete *i;
+        bWindowResizePending_ = false;
+        mainWin_->setSize(winSize_.x, winSize_.y);
     }
-    preRenderDeleteQueue_.clear();
+
+    updateLayouts();
 
     for (std::list<GuiObject*>::iterator i = preRenderUpdateQueue_.begin();
         i != preRenderUpdateQueue_.end(); ++i)
@@ -439,6 +519,20 @@ WManager::registerForPreRenderUpdate(GuiObject* o)
 }
 
 
+void
+WManager::scheduleLayout(GuiObject* o)
+{
+    layoutQueue_.push_back(o);
+}
+
+
+void
+WManager::setLayout(Layout* layout)
+{
+    mainWin_->setLayout(layout);
+}
+
+
 void
 WManager::markForDeletion(GuiObject* o)
 {
@@ -462,9 +556,21 @@ WManager::indicateRemovedObject(const GuiObject* o)
         clickedObj_ = 0;
     }
 
-    if (o == hoveredObj_)
+    if (o == focusedObj_)
+    {
+        MSG("WManager::indicateRemovedObject [focusedObj_]: " << (void*)focusedObj_);
+        focusedObj_ = 0;
+    }
+
+    std::vector<GuiObject*>::iterator h =
+        std::find(hoverPath_.begin(), hoverPath_.end(), o);
+    if (h != hoverPath_.end())
     {
         MSG("WManager::indicateRemovedObject [hoveredObj_]: " << (void*)hoveredObj_);
+
+        // The objects behind o on the hover path are embedded in o, so they
+        // are gone as well
+        hoverPath_.erase(h, hoverPath_.end());
         hoveredObj_ = 0;
 
         // Make sure that we're not left in a state where no object is hovered.
@@ -475,10 +581,35 @@ WManager::indicateRemovedObject(const GuiObject* o)
         // indicateRemovedObject()).
         if (o != mainWin_)
         {
-            feedMouseMoveInternal(mousePos_, Point(), 0);
+            if (removalBatchDepth_ > 0)
+            {
+                // Objects of the batch may still be referenced by their
+                // parents, so wait until the batch is complete
+                bHoverLost_ = true;
+            }
+            else
+            {
+                feedMouseMoveInternal(mousePos_, Point(), 0);
+            }
         }
     }
 
+    if (removalBatchDepth_ > 0)
+    {
+        removedObjects_.push_back(o);
+        return;
+    }
+
+    // Drop pending preRenderUpdate() calls for the object
+    preRenderUpdateQueue_.remove(const_cast<GuiObject*>(o));
+
+    // Drop posted commands that would call the object
+    commandQueue_.removeCommands(static_cast<const void*>(o));
+
+    // Drop a pending layout update
+    layoutQueue_.erase(std::remove(layoutQueue_.begin(), layoutQueue_.end(), o),
+        layoutQueue_.end());
+
     // Remove all timers running for this GuiObject
     for (std::list<Timer*>::iterator i = timerList_.begin();
         i != timerList_.end(); )
@@ -497,6 +628,221 @@ WManager::indicateRemovedObject(const GuiObject* o)
 }
 
 
+void
+WManager::beginRemovalBatch()
+{
+    ++removalBatchDepth_;
+}
+
+
+void
+WManager::endRemovalBatch()
+{
+    if (removalBatchDepth_ == 0)
+    {
+        Log::warning("WManager", "endRemovalBatch() without matching "
+            "beginRemovalBatch()");
+        return;
+    }
+
+    if (--removalBatchDepth_ > 0)
+    {
+        return;
+    }
+
+    dropRemovedObjects();
+
+    if (bHoverLost_)
+    {
+        bHoverLost_ = false;
+        feedMouseMoveInternal(mousePos_, Point(), 0);
+    }
+}
+
+
+void
+WManager::dropRemovedObjects()
+{
+    if (removedObjects_.empty())
+    {
+        return;
+    }
+
+    std::sort(removedObjects_.begin(), removedObjects_.end());
+    const std::vector<const GuiObject*>& r = removedObjects_;
+
+    for (std::list<GuiObject*>::iterator i = preRenderUpdateQueue_.begin();
+        i != preRenderUpdateQueue_.end(); )
+    {
+        if (std::binary_search(r.begin(), r.end(), *i))
+        {
+            i = preRenderUpdateQueue_.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    unsigned int n = 0;
+    for (unsigned int i = 0; i != layoutQueue_.size(); ++i)
+    {
+        if (!std::binary_search(r.begin(), r.end(), layoutQueue_[i]))
+        {
+            layoutQueue_[n++] = layoutQueue_[i];
+        }
+    }
+    layoutQueue_.resize(n);
+
+    // removedObjects_ is sorted, so the target list is as well; it is only
+    // built if commands are pending
+    if (commandQueue_.getStats().pending != 0)
+    {
+        commandQueue_.removeCommands(
+            std::vector<const void*>(r.begin(), r.end()));
+    }
+
+    // Timers refer to TimerListeners, so compare against the objects'
+    // TimerListener parts
+    std::vector<const TimerListener*> listeners(r.begin(), r.end());
+    std::sort(listeners.begin(), listeners.end());
+    for (std::list<Timer*>::iterator i = timerList_.begin();
+        i != timerList_.end(); )
+    {
+        if (std::binary_search(listeners.begin(), listeners.end(),
+            (*i)->target))
+        {
+            delete *i;
+            i = timerList_.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    removedObjects_.clear();
+}
+
+
+bool
+WManager::postCommand(Command* c)
+{
+    return commandQueue_.post(c);
+}
+
+
+CommandQueue&
+WManager::getCommandQueue()
+{
+    return commandQueue_;
+}
+
+
+void
+WManager::setFocus(GuiObject* o)
+{
+    if (o == focusedObj_)
+    {
+        return;
+    }
+
+    if (o && !o->isFocusable())
+    {
+        Log::warning("WManager", Log::os() << "Attempt to focus object "
+            << (void*)o << ", which is not focusable");
+        return;
+    }
+
+    if (focusedObj_)
+    {
+        focusedObj_->setFocused(false);
+    }
+
+    focusedObj_ = o;
+
+    if (focusedObj_)
+    {
+        focusedObj_->setFocused(true);
+    }
+}
+
+
+GuiObject*
+WManager::getFocusedObject() const
+{
+    return focusedObj_;
+}
+
+
+void
+WManager::focusNext()
+{
+    moveFocus(1);
+}
+
+
+void
+WManager::focusPrevious()
+{
+    moveFocus(-1);
+}
+
+
+void
+WManager::setTabFocusTraversal(bool state)
+{
+    bTabFocusTraversal_ = state;
+}
+
+
+void
+WManager::addShortcut(int key, int modifiers, KeyListener* l)
+{
+    int idx = getShortcutIndex(key, modifiers);
+    if (idx < 0)
+    {
+        Log::warning("WManager", Log::os() << "Key " << key
+            << " cannot be used as a shortcut");
+    }
+    else
+    {
+        shortcuts_[idx] = l;
+    }
+}
+
+
+void
+WManager::removeShortcut(int key, int modifiers)
+{
+    int idx = getShortcutIndex(key, modifiers);
+    if (idx >= 0)
+    {
+        shortcuts_[idx] = 0;
+    }
+}
+
+
+int
+WManager::getKeyModifiers() const
+{
+    int mods = GW1K_MOD_NONE;
+    if (pressedModifierKeys_ & (MODKEY_LSHIFT | MODKEY_RSHIFT))
+    {
+        mods |= GW1K_MOD_SHIFT;
+    }
+    if (pressedModifierKeys_ & (MODKEY_LCTRL | MODKEY_RCTRL))
+    {
+        mods |= GW1K_MOD_CTRL;
+    }
+    if (pressedModifierKeys_ & (MODKEY_LALT | MODKEY_RALT))
+    {
+        mods |= GW1K_MOD_ALT;
+    }
+    return mods;
+}
+
+
 void
 WManager::addTimer(double seconds, TimerListener* target, int token)
 {
@@ -567,7 +913,7 @@ void
 WManager::checkTimers()
 {
     timeval now;
-    gettimeofday(&now, 0);
+    Timer::getTime(now);
 
     while (!timerList_.empty() && timerList_.front()->expired(now))
     {
@@ -579,4 +925,170 @@ WManager::checkTimers()
 }
 
 
+void
+WManager::updateLayouts()
+{
+    if (layoutQueue_.empty())
+    {
+        return;
+    }
+
+    // Sort by depth, so a container resized by its parent's layout is only laid
+    // out once, after its parent
+    std::vector<std::pair<int, GuiObject*> > sorted;
+    sorted.reserve(layoutQueue_.size());
+    for (unsigned int i = 0; i != layoutQueue_.size(); ++i)
+    {
+        int depth = 0;
+        for (GuiObject* p = layoutQueue_[i]->getParent(); p; p = p->getParent())
+        {
+            ++depth;
+        }
+        sorted.push_back(std::make_pair(depth, layoutQueue_[i]));
+    }
+    std::sort(sorted.begin(), sorted.end());
+    for (unsigned int i = 0; i != sorted.size(); ++i)
+    {
+        layoutQueue_[i] = sorted[i].second;
+    }
+
+    // Laying out may resize sub-containers, which are appended to the queue
+    for (unsigned int i = 0; i != layoutQueue_.size(); ++i)
+    {
+        layoutQueue_[i]->updateLayout();
+    }
+    layoutQueue_.clear();
+}
+
+
+void
+WManager::processDeleteQueue()
+{
+    if (preRenderDeleteQueue_.empty())
+    {
+        return;
+    }
+
+    // Sort deepest objects first and group them by parent; duplicates end up
+    // next to each other. Objects marked while deleting are handled next frame.
+    typedef std::pair<std::pair<int, GuiObject*>, GuiObject*> Entry;
+    std::vector<Entry> sorted;
+    sorted.reserve(preRenderDeleteQueue_.size());
+    for (unsigned int i = 0; i != preRenderDeleteQueue_.size(); ++i)
+    {
+        GuiObject* o = preRenderDeleteQueue_[i];
+        int depth = 0;
+        for (GuiObject* p = o->getParent(); p; p = p->getParent())
+        {
+            ++depth;
+        }
+        sorted.push_back(std::make_pair(std::make_pair(-depth, o->getParent()),
+            o));
+    }
+    preRenderDeleteQueue_.clear();
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    beginRemovalBatch();
+    std::vector<GuiObject*> siblings;
+    for (unsigned int i = 0; i != sorted.size(); )
+    {
+        GuiObject* p = sorted[i].first.second;
+        siblings.clear();
+        for (; (i != sorted.size()) && (sorted[i].first.second == p); ++i)
+        {
+            siblings.push_back(sorted[i].second);
+        }
+
+        if (p)
+        {
+            p->removeSubObjects(siblings);
+        }
+        for (unsigned int j = 0; j != siblings.size(); ++j)
+        {
+            delete siblings[j];
+        }
+    }
+    endRemovalBatch();
+}
+
+
+void
+WManager::moveFocus(int step)
+{
+    std::vector<GuiObject*> focusables;
+    mainWin_->collectFocusableObjects(focusables);
+
+    int n = focusables.size();
+    if (n == 0)
+    {
+        return;
+    }
+
+    int idx = -1;
+    for (int i = 0; i != n; ++i)
+    {
+        if (focusables[i] == focusedObj_)
+        {
+            idx = i;
+            break;
+        }
+    }
+
+    if (idx < 0)
+    {
+        // Nothing focused yet (or focused object not reachable anymore), so
+        // start at the front or back of the tab order
+        idx = (step > 0) ? 0 : n - 1;
+    }
+    else
+    {
+        idx = (idx + step % n + n) % n;
+    }
+
+    setFocus(focusables[idx]);
+}
+
+
+void
+WManager::updateFocusOnClick(GuiObject* clickedObj)
+{
+    // Focus follows click: focus the clicked object or its closest focusable
+    // parent; clicking on a non-focusable area clears the focus
+    GuiObject* o = clickedObj;
+    while (o && !o->isFocusable())
+    {
+        o = o->getParent();
+    }
+    setFocus(o);
+}
+
+
+void
+WManager::updateModifierKeys(int key, StateEvent ev)
+{
+    int bit = getModifierKeyBit(key);
+    if (ev == GW1K_PRESSED)
+    {
+        pressedModifierKeys_ |= bit;
+    }
+    else
+    {
+        pressedModifierKeys_ &= ~bit;
+    }
+}
+
+
+int
+WManager::getShortcutIndex(int key, int modifiers) const
+{
+    if ((key < 0) || (key >= NUM_KEY_CODES)
+        || (modifiers < 0) || (modifiers >= NUM_MODIFIER_COMBINATIONS))
+    {
+        return -1;
+    }
+    return modifiers * NUM_KEY_CODES + key;
+}
+
+
 } // namespace gw1k
@@ -0,0 +1,843 @@
+#include "WidgetSnapshot.h"
+
+#include "GuiObject.h"
+#include "widgets/Box.h"
+#include "widgets/WiBox.h"
+#include "widgets/Label.h"
+#include "ThemeManager.h"
+#include "FTGLFontManager.h"
+#include "MemoryReport.h"
+#include "Log.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <typeinfo>
+
+namespace gw1k
+{
+
+
+namespace
+{
+
+
+const char MAGIC[] = "GW1KSNAP";
+
+const int MAGIC_SIZE = 8;
+
+const unsigned int VERSION = 1;
+
+/** Written in native byte order, so loading detects a different byte order */
+const unsigned int BYTE_ORDER_MARK = 0x01020304;
+
+/** A byte telling which colours are set, and the RGBA values of six colours */
+const unsigned int COLOR_TABLE_SIZE = 1 + 6 * 4;
+
+/** Index used for "no font" */
+const unsigned int NO_FONT = 0xFFFFFFFF;
+
+/** Limits the recursion when loading corrupt files */
+const unsigned int MAX_DEPTH = 256;
+
+
+enum WidgetType { TYPE_BOX, TYPE_WIBOX, TYPE_LABEL, TYPE_UNSUPPORTED };
+
+
+enum WidgetFlag
+{
+    FLAG_VISIBLE = 1,
+    FLAG_INTERACTIVE = 2,
+    FLAG_CLICK_THROUGH = 4,
+    FLAG_FOCUSABLE = 8,
+    FLAG_DRAGGABLE = 16,
+    FLAG_RESIZEABLE = 32,
+    FLAG_EMBEDDED = 64
+};
+
+
+const TextProperty ALIGNMENTS[] = { GW1K_ALIGN_LEFT, GW1K_ALIGN_CENTER,
+    GW1K_ALIGN_RIGHT, GW1K_ALIGN_JUSTIFY, GW1K_ALIGN_TOP,
+    GW1K_ALIGN_VERT_CENTER, GW1K_ALIGN_BOTTOM };
+
+
+WidgetType
+getType(const GuiObject* o)
+{
+    // Derived classes may have state (and sub-objects) the snapshot doesn't
+    // know about, so only the exact types are supported
+    const std::type_info& t = typeid(*o);
+    if (t == typeid(Label))
+    {
+        return TYPE_LABEL;
+    }
+    else if (t == typeid(WiBox))
+    {
+        return TYPE_WIBOX;
+    }
+    else if (t == typeid(Box))
+    {
+        return TYPE_BOX;
+    }
+    return TYPE_UNSUPPORTED;
+}
+
+
+/**
+ * Suspends theme and font lookups while widgets are created from a snapshot.
+ */
+class BulkConstruction
+{
+
+public:
+
+    BulkConstruction()
+    {
+        ThemeManager::getInstance()->setLookupsSuspended(true);
+        Text::setFontLookupsDeferred(true);
+    }
+
+    ~BulkConstruction()
+    {
+        ThemeManager::getInstance()->setLookupsSuspended(false);
+        Text::setFontLookupsDeferred(false);
+    }
+
+};
+
+
+/**
+ * Collects the sections of a snapshot file. The file consists of a header,
+ * the colour tables (a byte telling which colours are set, followed by the
+ * RGBA values of all six colours), the fonts (name and face size), the widget
+ * records in depth-first order, and the strings the other sections refer to.
+ */
+class SnapshotWriter
+{
+
+public:
+
+    SnapshotWriter()
+    :   numColorTables_(0),
+        numFonts_(0),
+        numWidgets_(0)
+    {}
+
+    void addWidget(const GuiObject* o,
+                   WidgetType type,
+                   const std::vector<GuiObject*>& subObjects);
+
+    bool write(const char* filename) const;
+
+private:
+
+    template <typename T>
+    static void put(std::vector<char>& buf, const T& v)
+    {
+        const char* p = reinterpret_cast<const char*>(&v);
+        buf.insert(buf.end(), p, p + sizeof(T));
+    }
+
+    void putString(std::vector<char>& buf, const std::string& s);
+
+    unsigned int addColorTable(const ColorTable& ct);
+
+    unsigned int addFont(const std::string& name, unsigned int faceSize);
+
+private:
+
+    std::vector<char> colorTables_;
+
+    unsigned int numColorTables_;
+
+    std::map<std::string, unsigned int> colorTableIndices_;
+
+    std::vector<char> fonts_;
+
+    unsigned int numFonts_;
+
+    std::map<std::pair<std::string, unsigned int>, unsigned int> fontIndices_;
+
+    std::vector<char> widgets_;
+
+    unsigned int numWidgets_;
+
+    std::string strings_;
+
+};
+
+
+void
+SnapshotWriter::addWidget(
+    const GuiObject* o,
+    WidgetType type,
+    const std::vector<GuiObject*>& subObjects)
+{
+    ++numWidgets_;
+    put<unsigned char>(widgets_, type);
+
+    unsigned int flags = (o->isVisible() ? FLAG_VISIBLE : 0)
+        | (o->isInteractive() ? FLAG_INTERACTIVE : 0)
+        | (o->isClickThrough() ? FLAG_CLICK_THROUGH : 0)
+        | (o->isFocusable() ? FLAG_FOCUSABLE : 0)
+        | (o->isDraggable() ? FLAG_DRAGGABLE : 0)
+        | (o->isResizeable() ? FLAG_RESIZEABLE : 0)
+        | (o->isEmbedded() ? FLAG_EMBEDDED : 0);
+    put(widgets_, flags);
+
+    const Point& pos = o->getPos();
+    const Point& size = o->getSize();
+    put(widgets_, pos.x);
+    put(widgets_, pos.y);
+    put(widgets_, size.x);
+    put(widgets_, size.y);
+
+    const Renderable* r = static_cast<const Renderable*>(o);
+    put(widgets_, addColorTable(r->getColorTable()));
+
+    if (type != TYPE_BOX)
+    {
+        const WiBox* w = static_cast<const WiBox*>(o);
+        put(widgets_, w->getCornerRadius());
+        put(widgets_, w->getBorderWidth());
+        put(widgets_, addColorTable(w->getGradientColors()));
+    }
+
+    if (type == TYPE_LABEL)
+    {
+        const Label* l = static_cast<const Label*>(o);
+        const Text& text = l->getTextWidget();
+        const Renderable* textBox =
+            dynamic_cast<const Renderable*>(text.getParent());
+        put(widgets_, addColorTable(textBox->getColorTable()));
+        put(widgets_, addColorTable(text.getColorTable()));
+
+        TextLayout layout;
+        text.getLayout(layout);
+        putString(widgets_, text.getText());
+        put(widgets_, layout.font ?
+            addFont(layout.fontName, layout.faceSize) : NO_FONT);
+        put(widgets_, l->getTextProperties());
+        put(widgets_, l->getPadding().x);
+        put(widgets_, l->getPadding().y);
+        put<unsigned char>(widgets_, l->isAutoSized());
+        put(widgets_, l->getLineLength());
+        put(widgets_, layout.bbox.Lower().Xf());
+        put(widgets_, layout.bbox.Lower().Yf());
+        put(widgets_, layout.bbox.Upper().Xf());
+        put(widgets_, layout.bbox.Upper().Yf());
+        put<unsigned char>(widgets_, layout.bLineLengthSet);
+        put(widgets_, layout.width);
+    }
+
+    put(widgets_, static_cast<unsigned int>(subObjects.size()));
+}
+
+
+bool
+SnapshotWriter::write(const char* filename) const
+{
+    std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        Log::error("WidgetSnapshot", Log::os() << "Cannot write " << filename);
+        return false;
+    }
+
+    std::vector<char> header(MAGIC, MAGIC + MAGIC_SIZE);
+    put(header, BYTE_ORDER_MARK);
+    put(header, VERSION);
+    put(header, numColorTables_);
+    put(header, numFonts_);
+    put(header, numWidgets_);
+    put(header, static_cast<unsigned int>(widgets_.size()));
+    put(header, static_cast<unsigned int>(strings_.size()));
+
+    file.write(&header[0], header.size());
+    file.write(&colorTables_[0], colorTables_.size());
+    if (!fonts_.empty())
+    {
+        file.write(&fonts_[0], fonts_.size());
+    }
+    file.write(&widgets_[0], widgets_.size());
+    file.write(strings_.data(), strings_.size());
+
+    if (!file)
+    {
+        Log::error("WidgetSnapshot", Log::os() << "Cannot write " << filename);
+        return false;
+    }
+    return true;
+}
+
+
+void
+SnapshotWriter::putString(std::vector<char>& buf, const std::string& s)
+{
+    put(buf, static_cast<unsigned int>(strings_.size()));
+    put(buf, static_cast<unsigned int>(s.size()));
+    strings_.append(s);
+}
+
+
+unsigned int
+SnapshotWriter::addColorTable(const ColorTable& ct)
+{
+    const Color4i* cols[] = { ct.fgCol, ct.bgCol, ct.hoveredFgCol,
+        ct.hoveredBgCol, ct.clickedFgCol, ct.clickedBgCol };
+
+    std::vector<char> record;
+    unsigned char mask = 0;
+    for (int i = 0; i != 6; ++i)
+    {
+        const Color4i* c = cols[i];
+        mask |= c ? (1 << i) : 0;
+        put<unsigned char>(record, c ? c->r : 0);
+        put<unsigned char>(record, c ? c->g : 0);
+        put<unsigned char>(record, c ? c->b : 0);
+        put<unsigned char>(record, c ? c->a : 0);
+    }
+    record.insert(record.begin(), mask);
+
+    // Most widgets share a few colour tables, so each is stored only once
+    std::string key(record.begin(), record.end());
+    std::map<std::string, unsigned int>::const_iterator it =
+        colorTableIndices_.find(key);
+    if (it != colorTableIndices_.end())
+    {
+        return it->second;
+    }
+    colorTables_.insert(colorTables_.end(), record.begin(), record.end());
+    colorTableIndices_[key] = numColorTables_;
+    return numColorTables_++;
+}
+
+
+unsigned int
+SnapshotWriter::addFont(const std::string& name, unsigned int faceSize)
+{
+    std::pair<std::string, unsigned int> key(name, faceSize);
+    std::map<std::pair<std::string, unsigned int>, unsigned int>::const_iterator
+        it = fontIndices_.find(key);
+    if (it != fontIndices_.end())
+    {
+        return it->second;
+    }
+    putString(fonts_, name);
+    put(fonts_, faceSize);
+    fontIndices_[key] = numFonts_;
+    return numFonts_++;
+}
+
+
+/**
+ * Reads values from a memory-mapped snapshot, checking bounds.
+ */
+class SnapshotReader
+{
+
+public:
+
+    SnapshotReader(const char* data, unsigned long size)
+    :   p_(data),
+        end_(data + size),
+        bFailed_(false)
+    {}
+
+    template <typename T>
+    T get()
+    {
+        T v = T();
+        if (static_cast<unsigned long>(end_ - p_) < sizeof(T))
+        {
+            bFailed_ = true;
+            return v;
+        }
+        std::memcpy(&v, p_, sizeof(T));
+        p_ += sizeof(T);
+        return v;
+    }
+
+    /**
+     * Gets a pointer to the next size bytes and skips them, or returns 0 if
+     * there are not enough bytes.
+     */
+    const char* skip(unsigned long size)
+    {
+        if (static_cast<unsigned long>(end_ - p_) < size)
+        {
+            bFailed_ = true;
+            return 0;
+        }
+        const char* p = p_;
+        p_ += size;
+        return p;
+    }
+
+    void fail()
+    {
+        bFailed_ = true;
+    }
+
+    bool failed() const
+    {
+        return bFailed_;
+    }
+
+private:
+
+    const char* p_;
+
+    const char* end_;
+
+    bool bFailed_;
+
+};
+
+
+struct SnapshotFont
+{
+    std::string name;
+
+    unsigned int faceSize;
+
+    FTFont* font;
+
+    float scale;
+};
+
+
+/**
+ * Creates widgets from a snapshot.
+ */
+class SnapshotLoader
+{
+
+public:
+
+    SnapshotLoader(const char* data, unsigned long size)
+    :   reader_(data, size),
+        strings_(0),
+        stringsSize_(0)
+    {}
+
+    /**
+     * Releases the fonts acquired by load(); the Texts created hold their own
+     * references.
+     */
+    ~SnapshotLoader();
+
+    GuiObject* load();
+
+private:
+
+    bool readString(SnapshotReader& r, std::string& s);
+
+    const ColorTable& getColorTable(unsigned int index);
+
+    GuiObject* createWidget(unsigned int depth);
+
+    /**
+     * Deletes the widgets created so far, sub-objects first.
+     */
+    void deleteWidgets();
+
+private:
+
+    SnapshotReader reader_;
+
+    const char* strings_;
+
+    unsigned int stringsSize_;
+
+    std::vector<ColorTable> colorTables_;
+
+    std::vector<SnapshotFont> fonts_;
+
+    /** The widgets created, in creation order */
+    std::vector<GuiObject*> widgets_;
+
+};
+
+
+SnapshotLoader::~SnapshotLoader()
+{
+    // fonts_ is value-initialised, so fonts not looked up are 0
+    FTGLFontManager& fm = FTGLFontManager::Instance();
+    for (unsigned int i = 0; i != fonts_.size(); ++i)
+    {
+        if (fonts_[i].font)
+        {
+            fm.ReleaseFont(fonts_[i].font);
+        }
+    }
+}
+
+
+GuiObject*
+SnapshotLoader::load()
+{
+    SnapshotReader& r = reader_;
+    const char* magic = r.skip(MAGIC_SIZE);
+    if (!magic || (std::memcmp(magic, MAGIC, MAGIC_SIZE) != 0)
+        || (r.get<unsigned int>() != BYTE_ORDER_MARK)
+        || (r.get<unsigned int>() != VERSION))
+    {
+        Log::error("WidgetSnapshot", "Not a snapshot of this gw1k version or "
+            "byte order");
+        return 0;
+    }
+
+    unsigned int numColorTables = r.get<unsigned int>();
+    unsigned int numFonts = r.get<unsigned int>();
+    unsigned int numWidgets = r.get<unsigned int>();
+    unsigned int widgetsSize = r.get<unsigned int>();
+    stringsSize_ = r.get<unsigned int>();
+
+    const char* colorTables = r.skip(numColorTables * COLOR_TABLE_SIZE);
+    const char* fonts = r.skip(numFonts * 3 * sizeof(unsigned int));
+    const char* widgets = r.skip(widgetsSize);
+    strings_ = r.skip(stringsSize_);
+    if (r.failed() || (numWidgets == 0))
+    {
+        Log::error("WidgetSnapshot", "Snapshot is truncated");
+        return 0;
+    }
+
+    colorTables_.resize(numColorTables);
+    SnapshotReader ctReader(colorTables, numColorTables * COLOR_TABLE_SIZE);
+    for (unsigned int i = 0; i != numColorTables; ++i)
+    {
+        ColorTable& ct = colorTables_[i];
+        Color4i** cols[] = { &ct.fgCol, &ct.bgCol, &ct.hoveredFgCol,
+            &ct.hoveredBgCol, &ct.clickedFgCol, &ct.clickedBgCol };
+        unsigned char mask = ctReader.get<unsigned char>();
+        for (int j = 0; j != 6; ++j)
+        {
+            int red = ctReader.get<unsigned char>();
+            int green = ctReader.get<unsigned char>();
+            int blue = ctReader.get<unsigned char>();
+            int alpha = ctReader.get<unsigned char>();
+            if (mask & (1 << j))
+            {
+                Color4i c(red, green, blue, alpha);
+                setColor(&c, *cols[j]);
+            }
+        }
+    }
+
+    // Fonts are looked up once here rather than once per Text
+    fonts_.resize(numFonts);
+    SnapshotReader fontReader(fonts, numFonts * 3 * sizeof(unsigned int));
+    FTGLFontManager& fm = FTGLFontManager::Instance();
+    for (unsigned int i = 0; i != numFonts; ++i)
+    {
+        SnapshotFont& f = fonts_[i];
+        if (!readString(fontReader, f.name))
+        {
+            Log::error("WidgetSnapshot", "Invalid font name in snapshot");
+            return 0;
+        }
+        f.faceSize = fontReader.get<unsigned int>();
+        f.font = fm.GetRenderFont(f.name.c_str(), f.faceSize, f.scale);
+
+        // Looking up the next font may evict unreferenced ones
+        if (f.font)
+        {
+            fm.AcquireFont(f.font);
+        }
+    }
+
+    GuiObject* root;
+    {
+        BulkConstruction bc;
+        reader_ = SnapshotReader(widgets, widgetsSize);
+        root = createWidget(0);
+    }
+
+    if (root && (widgets_.size() != numWidgets))
+    {
+        root = 0;
+    }
+    if (!root)
+    {
+        Log::error("WidgetSnapshot", "Invalid widget data in snapshot");
+        deleteWidgets();
+    }
+    return root;
+}
+
+
+bool
+SnapshotLoader::readString(SnapshotReader& r, std::string& s)
+{
+    unsigned int offset = r.get<unsigned int>();
+    unsigned int length = r.get<unsigned int>();
+    if (r.failed() || (offset > stringsSize_)
+        || (length > stringsSize_ - offset))
+    {
+        r.fail();
+        return false;
+    }
+    s.assign(strings_ + offset, length);
+    return true;
+}
+
+
+const ColorTable&
+SnapshotLoader::getColorTable(unsigned int index)
+{
+    static const ColorTable empty;
+    if (index >= colorTables_.size())
+    {
+        reader_.fail();
+        return empty;
+    }
+    return colorTables_[index];
+}
+
+
+GuiObject*
+SnapshotLoader::createWidget(unsigned int depth)
+{
+    SnapshotReader& r = reader_;
+    ThemeManager* tm = ThemeManager::getInstance();
+
+    unsigned char type = r.get<unsigned char>();
+    unsigned int flags = r.get<unsigned int>();
+    int x = r.get<int>();
+    int y = r.get<int>();
+    int w = r.get<int>();
+    int h = r.get<int>();
+    const ColorTable& colors = getColorTable(r.get<unsigned int>());
+    if (r.failed() || (depth > MAX_DEPTH))
+    {
+        return 0;
+    }
+
+    Point pos(x, y);
+    Point size(w, h);
+    Renderable* o;
+
+    if (type == TYPE_BOX)
+    {
+        o = new Box(pos, size);
+        widgets_.push_back(o);
+    }
+    else if ((type == TYPE_WIBOX) || (type == TYPE_LABEL))
+    {
+        float cornerRadius = r.get<float>();
+        float borderWidth = r.get<float>();
+        const ColorTable& gradientColors = getColorTable(r.get<unsigned int>());
+
+        WiBox* wiBox;
+        if (type == TYPE_LABEL)
+        {
+            const ColorTable& boxColors = getColorTable(r.get<unsigned int>());
+            const ColorTable& textColors = getColorTable(r.get<unsigned int>());
+            std::string text;
+            readString(r, text);
+            unsigned int font = r.get<unsigned int>();
+            int textProps = r.get<int>();
+            int paddingX = r.get<int>();
+            int paddingY = r.get<int>();
+            bool bAutoSized = r.get<unsigned char>();
+            int lineLength = r.get<int>();
+            float lowerX = r.get<float>();
+            float lowerY = r.get<float>();
+            float upperX = r.get<float>();
+            float upperY = r.get<float>();
+            bool bLineLengthSet = r.get<unsigned char>();
+            int textWidth = r.get<int>();
+            if (r.failed() || ((font != NO_FONT) && (font >= fonts_.size())))
+            {
+                return 0;
+            }
+
+            // Neither theme nor fonts are looked up, and no text is measured
+            // while setting up the Label, since its text has no font before
+            // restoreTextLayout()
+            Label* l = new Label(pos, size, text, bAutoSized);
+            widgets_.push_back(l);
+            l->setPadding(Point(paddingX, paddingY));
+            for (unsigned int i = 0;
+                i != sizeof(ALIGNMENTS) / sizeof(ALIGNMENTS[0]); ++i)
+            {
+                if (textProps & ALIGNMENTS[i])
+                {
+                    l->setTextProperty(ALIGNMENTS[i]);
+                }
+            }
+
+            TextLayout layout;
+            if (font != NO_FONT)
+            {
+                const SnapshotFont& f = fonts_[font];
+                layout.fontName = f.name;
+                layout.faceSize = f.faceSize;
+                layout.font = f.font;
+                layout.fontScale = f.scale;
+            }
+            layout.bbox = FTBBox(FTPoint(lowerX, lowerY), FTPoint(upperX, upperY));
+            layout.bLineLengthSet = bLineLengthSet;
+            layout.width = textWidth;
+            l->restoreTextLayout(layout, lineLength);
+
+            Text& t = l->getTextWidget();
+            tm->setColors(dynamic_cast<Renderable*>(t.getParent()), boxColors);
+            tm->setColors(&t, textColors);
+            wiBox = l;
+        }
+        else
+        {
+            wiBox = new WiBox(pos, size);
+            widgets_.push_back(wiBox);
+        }
+
+        wiBox->setCornerRadius(cornerRadius);
+        wiBox->setBorderWidth(borderWidth);
+        wiBox->setGradientColors(gradientColors);
+        o = wiBox;
+    }
+    else
+    {
+        return 0;
+    }
+
+    tm->setColors(o, colors);
+    o->setVisible(flags & FLAG_VISIBLE);
+    o->setInteractive(flags & FLAG_INTERACTIVE);
+    o->setClickThrough(flags & FLAG_CLICK_THROUGH);
+    o->setFocusable(flags & FLAG_FOCUSABLE);
+    o->setDraggable(flags & FLAG_DRAGGABLE);
+    o->setResizeable(flags & FLAG_RESIZEABLE);
+    o->setEmbedded(flags & FLAG_EMBEDDED);
+
+    unsigned int numSubObjects = r.get<unsigned int>();
+    for (unsigned int i = 0; (i != numSubObjects) && !r.failed(); ++i)
+    {
+        GuiObject* subObj = createWidget(depth + 1);
+        if (!subObj)
+        {
+            return 0;
+        }
+        o->addSubObject(subObj);
+    }
+
+    return r.failed() ? 0 : o;
+}
+
+
+void
+SnapshotLoader::deleteWidgets()
+{
+    for (std::vector<GuiObject*>::reverse_iterator i = widgets_.rbegin();
+        i != widgets_.rend(); ++i)
+    {
+        GuiObject* o = *i;
+        if (o->getParent())
+        {
+            o->getParent()->removeSubObject(o);
+        }
+        delete o;
+    }
+    widgets_.clear();
+}
+
+
+} // namespace
+
+
+/*static*/
+bool
+WidgetSnapshot::write(const GuiObject* o, const char* filename)
+{
+    WidgetType type = getType(o);
+    if (type == TYPE_UNSUPPORTED)
+    {
+        Log::error("WidgetSnapshot", "Root widget type is not supported");
+        return false;
+    }
+
+    SnapshotWriter writer;
+
+    // Depth-first, each widget followed by its sub-objects
+    std::vector<std::pair<const GuiObject*, WidgetType> > stack;
+    stack.push_back(std::make_pair(o, type));
+    while (!stack.empty())
+    {
+        const GuiObject* cur = stack.back().first;
+        WidgetType curType = stack.back().second;
+        stack.pop_back();
+
+        // A Label's text box is part of the Label
+        const GuiObject* internal = (curType == TYPE_LABEL) ?
+            static_cast<const Label*>(cur)->getTextWidget().getParent() : 0;
+
+        std::vector<GuiObject*> subObjects;
+        std::vector<std::pair<const GuiObject*, WidgetType> > pending;
+        for (unsigned int i = 0; i != cur->subObjects_.size(); ++i)
+        {
+            GuiObject* subObj = cur->subObjects_[i];
+            WidgetType subType = getType(subObj);
+            if (subObj == internal)
+            {
+                continue;
+            }
+            else if (subType == TYPE_UNSUPPORTED)
+            {
+                Log::warning("WidgetSnapshot", Log::os() << "Skipping widget "
+                    "of unsupported type " << MemoryReport::getClassName(subObj));
+                continue;
+            }
+            subObjects.push_back(subObj);
+            pending.push_back(std::make_pair(subObj, subType));
+        }
+
+        writer.addWidget(cur, curType, subObjects);
+        stack.insert(stack.end(), pending.rbegin(), pending.rend());
+    }
+
+    return writer.write(filename);
+}
+
+
+/*static*/
+GuiObject*
+WidgetSnapshot::load(const char* filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        Log::error("WidgetSnapshot", Log::os() << "Could not open " << filename);
+        return 0;
+    }
+
+    struct stat st;
+    void* data = MAP_FAILED;
+    unsigned long size = 0;
+    if ((fstat(fd, &st) == 0) && (st.st_size > 0))
+    {
+        size = st.st_size;
+        data = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        Log::error("WidgetSnapshot", Log::os() << "Could not map " << filename);
+        return 0;
+    }
+
+    GuiObject* root = SnapshotLoader(static_cast<const char*>(data), size).load();
+    munmap(data, size);
+    return root;
+}
+
+
+} // namespace gw1k
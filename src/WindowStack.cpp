@@ -2,7 +2,9 @@
 
 #include "WManager.h"
 
-#define GW1K_ENABLE_GL_ERROR_CHECKS
+// Scissors are pushed and popped for every clipping widget, so this file's
+// check points are disabled by default
+//#define GW1K_ENABLE_GL_ERROR_CHECKS
 #include "GLErrorCheck.h"
 
 #include <GL/glew.h>
@@ -101,11 +103,42 @@ WindowStack::popGlScissorOffset()
 }
 
 
+const Point&
+WindowStack::getGlScissorOffset() const
+{
+    return offset_;
+}
+
+
+void
+WindowStack::pushGlScissorOrigin(const Point& origin)
+{
+    originStack_.push_back(origin_);
+    origin_ = origin;
+    if (stack_.size() != 0)
+    {
+        setGlScissors(stack_.back());
+    }
+}
+
+
+void
+WindowStack::popGlScissorOrigin()
+{
+    origin_ = originStack_.back();
+    originStack_.pop_back();
+    if (stack_.size() != 0)
+    {
+        setGlScissors(stack_.back());
+    }
+}
+
+
 void
 WindowStack::setGlScissors(const int* i4) const
 {
     //MSG("scissors set to (" << i4[0] << ", " << i4[1] << "), (" << i4[2] << ", " << i4[3] << ")");
-    glScissor(i4[0], i4[1], i4[2], i4[3]);
+    glScissor(i4[0] - origin_.x, i4[1] - origin_.y, i4[2], i4[3]);
 }
 
 
@@ -0,0 +1,87 @@
+#include "layouts/BoxLayout.h"
+
+#include "GuiObject.h"
+
+#include <algorithm>
+
+namespace gw1k
+{
+
+
+BoxLayout::BoxLayout(Direction direction, int spacing, int padding)
+:   direction_(direction)
+{
+    spacing_ = spacing;
+    padding_ = padding;
+}
+
+
+BoxLayout::~BoxLayout()
+{}
+
+
+BoxLayout::Direction
+BoxLayout::getDirection() const
+{
+    return direction_;
+}
+
+
+void
+BoxLayout::apply(GuiObject* container)
+{
+    std::vector<GuiObject*> items;
+    getItems(container, items);
+    if (items.empty())
+    {
+        return;
+    }
+
+    // Work on (main, cross) axes instead of (x, y)
+    bool bH = (direction_ == HORIZONTAL);
+    const Point& size = container->getSize();
+    int mainSize = bH ? size.x : size.y;
+    int crossSize = std::max(0, (bH ? size.y : size.x) - 2 * padding_);
+
+    std::vector<Span> spans;
+    spans.reserve(items.size());
+    for (unsigned int i = 0; i != items.size(); ++i)
+    {
+        const GuiObject* o = items[i];
+        const Point& minSize = o->getMinSize();
+        const Point& maxSize = o->getMaxSize();
+        const Point& itemSize = o->getSize();
+        spans.push_back(Span(bH ? minSize.x : minSize.y,
+            bH ? maxSize.x : maxSize.y, o->getStretch(),
+            bH ? itemSize.x : itemSize.y));
+    }
+
+    int gaps = spacing_ * (items.size() - 1);
+    distribute(spans, mainSize - 2 * padding_ - gaps);
+
+    std::vector<int> pos;
+    getPositions(spans, padding_, spacing_, pos);
+
+    for (unsigned int i = 0; i != items.size(); ++i)
+    {
+        GuiObject* o = items[i];
+        const Point& minSize = o->getMinSize();
+        const Point& maxSize = o->getMaxSize();
+        int length = std::max(0, pos[i + 1] - pos[i] - spacing_);
+        if (bH)
+        {
+            int h = std::max(minSize.y, std::min(maxSize.y, crossSize));
+            o->setPos(pos[i], padding_);
+            o->setSize(length, h);
+        }
+        else
+        {
+            int w = std::max(minSize.x, std::min(maxSize.x, crossSize));
+            o->setPos(padding_, pos[i]);
+            o->setSize(w, length);
+        }
+    }
+}
+
+
+} // namespace gw1k
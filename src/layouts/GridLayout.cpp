@@ -0,0 +1,133 @@
+#include "layouts/GridLayout.h"
+
+#include "GuiObject.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace gw1k
+{
+
+
+GridLayout::GridLayout(int columns, int spacing, int padding)
+:   columns_(std::max(1, columns))
+{
+    spacing_ = spacing;
+    padding_ = padding;
+}
+
+
+GridLayout::~GridLayout()
+{}
+
+
+int
+GridLayout::getColumns() const
+{
+    return columns_;
+}
+
+
+void
+GridLayout::setColumnStretch(int column, float stretch)
+{
+    if (column >= 0)
+    {
+        if (column >= static_cast<int>(columnStretch_.size()))
+        {
+            columnStretch_.resize(column + 1, 1.f);
+        }
+        columnStretch_[column] = stretch;
+        invalidate();
+    }
+}
+
+
+void
+GridLayout::setRowStretch(int row, float stretch)
+{
+    if (row >= 0)
+    {
+        if (row >= static_cast<int>(rowStretch_.size()))
+        {
+            rowStretch_.resize(row + 1, 1.f);
+        }
+        rowStretch_[row] = stretch;
+        invalidate();
+    }
+}
+
+
+void
+GridLayout::apply(GuiObject* container)
+{
+    std::vector<GuiObject*> items;
+    getItems(container, items);
+    if (items.empty())
+    {
+        return;
+    }
+
+    int columns = std::min<int>(columns_, items.size());
+    int rows = (items.size() + columns_ - 1) / columns_;
+
+    const float inf = std::numeric_limits<float>::max();
+    std::vector<Span> colSpans(columns, Span(0.f, inf, 0.f, 0.f));
+    std::vector<Span> rowSpans(rows, Span(0.f, inf, 0.f, 0.f));
+    for (unsigned int i = 0; i != items.size(); ++i)
+    {
+        Span& col = colSpans[i % columns_];
+        Span& row = rowSpans[i / columns_];
+        const Point& minSize = items[i]->getMinSize();
+        const Point& maxSize = items[i]->getMaxSize();
+        col.min = std::max<float>(col.min, minSize.x);
+        col.max = std::min<float>(col.max, maxSize.x);
+        row.min = std::max<float>(row.min, minSize.y);
+        row.max = std::min<float>(row.max, maxSize.y);
+    }
+    for (int c = 0; c != columns; ++c)
+    {
+        Span& s = colSpans[c];
+        s.max = std::max(s.min, s.max);
+        s.size = s.min;
+        s.stretch = getStretch(columnStretch_, c);
+    }
+    for (int r = 0; r != rows; ++r)
+    {
+        Span& s = rowSpans[r];
+        s.max = std::max(s.min, s.max);
+        s.size = s.min;
+        s.stretch = getStretch(rowStretch_, r);
+    }
+
+    const Point& size = container->getSize();
+    distribute(colSpans, size.x - 2 * padding_ - spacing_ * (columns - 1));
+    distribute(rowSpans, size.y - 2 * padding_ - spacing_ * (rows - 1));
+
+    std::vector<int> colPos;
+    std::vector<int> rowPos;
+    getPositions(colSpans, padding_, spacing_, colPos);
+    getPositions(rowSpans, padding_, spacing_, rowPos);
+
+    for (unsigned int i = 0; i != items.size(); ++i)
+    {
+        GuiObject* o = items[i];
+        int c = i % columns_;
+        int r = i / columns_;
+        const Point& maxSize = o->getMaxSize();
+        int w = std::max(0, colPos[c + 1] - colPos[c] - spacing_);
+        int h = std::max(0, rowPos[r + 1] - rowPos[r] - spacing_);
+        o->setPos(colPos[c], rowPos[r]);
+        o->setSize(std::min(maxSize.x, w), std::min(maxSize.y, h));
+    }
+}
+
+
+float
+GridLayout::getStretch(const std::vector<float>& stretch, int i) const
+{
+    return (i < static_cast<int>(stretch.size())) ? stretch[i] : 1.f;
+}
+
+
+} // namespace gw1k
@@ -0,0 +1,176 @@
+#include "layouts/Layout.h"
+
+#include "GuiObject.h"
+#include "MathHelper.h"
+
+#include <algorithm>
+
+namespace gw1k
+{
+
+
+Layout::Span::Span(float min, float max, float stretch, float size)
+:   min(min),
+    max(std::max(min, max)),
+    stretch(stretch),
+    size(size)
+{}
+
+
+Layout::Layout()
+:   padding_(0),
+    spacing_(0),
+    container_(0)
+{}
+
+
+Layout::~Layout()
+{}
+
+
+void
+Layout::setPadding(int padding)
+{
+    padding_ = padding;
+    invalidate();
+}
+
+
+int
+Layout::getPadding() const
+{
+    return padding_;
+}
+
+
+void
+Layout::setSpacing(int spacing)
+{
+    spacing_ = spacing;
+    invalidate();
+}
+
+
+int
+Layout::getSpacing() const
+{
+    return spacing_;
+}
+
+
+void
+Layout::invalidate()
+{
+    if (container_)
+    {
+        container_->invalidateLayout();
+    }
+}
+
+
+/*static*/
+void
+Layout::getItems(const GuiObject* container, std::vector<GuiObject*>& items)
+{
+    const std::vector<GuiObject*>& subObjects = container->subObjects_;
+    for (unsigned int i = 0; i != subObjects.size(); ++i)
+    {
+        if (subObjects[i]->isVisible())
+        {
+            items.push_back(subObjects[i]);
+        }
+    }
+}
+
+
+/*static*/
+void
+Layout::distribute(std::vector<Span>& spans, float available)
+{
+    std::vector<bool> bFixed(spans.size(), false);
+    float totalStretch = 0.f;
+    for (unsigned int i = 0; i != spans.size(); ++i)
+    {
+        Span& s = spans[i];
+        if (s.stretch > 0.f)
+        {
+            totalStretch += s.stretch;
+        }
+        else
+        {
+            s.size = std::max(s.min, std::min(s.max, s.size));
+            available -= s.size;
+            bFixed[i] = true;
+        }
+    }
+
+    // Give each span its share; if shares violate minimum or maximum sizes,
+    // fix the spans on the side with the larger total violation at their
+    // bounds and divide the rest again (fixing both sides at once could move
+    // spans to a bound they wouldn't end up at)
+    while (totalStretch > 0.f)
+    {
+        float unit = available / totalStretch;
+        float underflow = 0.f;
+        float overflow = 0.f;
+        for (unsigned int i = 0; i != spans.size(); ++i)
+        {
+            if (!bFixed[i])
+            {
+                float share = unit * spans[i].stretch;
+                underflow += std::max(0.f, spans[i].min - share);
+                overflow += std::max(0.f, share - spans[i].max);
+            }
+        }
+
+        if ((underflow == 0.f) && (overflow == 0.f))
+        {
+            for (unsigned int i = 0; i != spans.size(); ++i)
+            {
+                if (!bFixed[i])
+                {
+                    spans[i].size = unit * spans[i].stretch;
+                }
+            }
+            break;
+        }
+
+        for (unsigned int i = 0; i != spans.size(); ++i)
+        {
+            Span& s = spans[i];
+            if (!bFixed[i])
+            {
+                float share = unit * s.stretch;
+                if ((underflow > overflow) ? (share < s.min) : (share > s.max))
+                {
+                    s.size = (underflow > overflow) ? s.min : s.max;
+                    available -= s.size;
+                    totalStretch -= s.stretch;
+                    bFixed[i] = true;
+                }
+            }
+        }
+    }
+}
+
+
+/*static*/
+void
+Layout::getPositions(
+    const std::vector<Span>& spans,
+    int start,
+    int spacing,
+    std::vector<int>& pos)
+{
+    pos.resize(spans.size() + 1);
+    pos[0] = start;
+    float p = start;
+    for (unsigned int i = 0; i != spans.size(); ++i)
+    {
+        p += spans[i].size + spacing;
+        pos[i + 1] = round_pos(p);
+    }
+}
+
+
+} // namespace gw1k
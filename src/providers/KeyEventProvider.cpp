@@ -32,4 +32,17 @@ KeyEventProvider::removeKeyListener(KeyListener* kl)
 }
 
 
+void
+KeyEventProvider::informKeyListeners(
+    int key,
+    StateEvent ev,
+    GuiObject* receiver)
+{
+    for (KeyListnrIter i = keyListeners_.begin(); i != keyListeners_.end(); ++i)
+    {
+        (*i)->keyEvent(key, ev, receiver);
+    }
+}
+
+
 } // namespace gw1k
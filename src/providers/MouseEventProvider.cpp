@@ -17,9 +17,13 @@ MouseEventProvider::~MouseEventProvider()
 
 
 void
-MouseEventProvider::addMouseListener(MouseListener* ml)
+MouseEventProvider::addMouseListener(MouseListener* ml, bool bHoverEvents)
 {
     mouseListeners_.push_back(ml);
+    if (bHoverEvents)
+    {
+        hoverListeners_.push_back(ml);
+    }
 }
 
 
@@ -27,6 +31,7 @@ void
 MouseEventProvider::removeMouseListener(MouseListener* ml)
 {
     mouseListeners_.remove(ml);
+    hoverListeners_.remove(ml);
 }
 
 
@@ -44,6 +49,19 @@ MouseEventProvider::informMouseListenersMoved(
 }
 
 
+void
+MouseEventProvider::informMouseListenersHovered(
+    const Point& pos,
+    const Point& delta,
+    GuiObject* receiver)
+{
+    for (MouseListnrIter i = hoverListeners_.begin(); i != hoverListeners_.end(); ++i)
+    {
+        (*i)->mouseMoved(GW1K_M_HOVERED, pos, delta, receiver);
+    }
+}
+
+
 void
 MouseEventProvider::informMouseListenersClicked(
     MouseButton b,
@@ -0,0 +1,146 @@
+#include "utils/NumberFormat.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+
+
+const double powersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12
+};
+
+
+/**
+ * Values at or above this limit are formatted via snprintf(), since their
+ * integer part and scaled fraction could not be represented exactly.
+ */
+const double FAST_PATH_LIMIT = 1e15;
+
+
+/**
+ * Writes the digits of v to buf, padded with leading zeros to minDigits
+ * digits, and returns the number of characters written.
+ */
+int writeDigits(unsigned long long v, int minDigits, char* buf)
+{
+    char tmp[24];
+    int n = 0;
+    do
+    {
+        tmp[n++] = '0' + static_cast<char>(v % 10);
+        v /= 10;
+    }
+    while (v != 0);
+
+    while (n < minDigits)
+    {
+        tmp[n++] = '0';
+    }
+
+    for (int i = 0; i != n; ++i)
+    {
+        buf[i] = tmp[n - 1 - i];
+    }
+    return n;
+}
+
+
+} // namespace
+
+
+namespace gw1k
+{
+
+
+int
+formatInt(long value, char* buf)
+{
+    int n = 0;
+    unsigned long long v = value;
+    if (value < 0)
+    {
+        buf[n++] = '-';
+        // Negate in unsigned arithmetic so LONG_MIN works as well
+        v = 0ull - v;
+    }
+
+    n += writeDigits(v, 1, buf + n);
+    buf[n] = '\0';
+    return n;
+}
+
+
+int
+formatFixed(double value, int precision, char* buf)
+{
+    if (precision < 0)
+    {
+        precision = 0;
+    }
+    else if (precision > NUMBER_FORMAT_MAX_PRECISION)
+    {
+        precision = NUMBER_FORMAT_MAX_PRECISION;
+    }
+
+    double absVal = std::fabs(value);
+    if (!(absVal < FAST_PATH_LIMIT)) // Also catches inf and nan
+    {
+        return std::snprintf(buf, NUMBER_FORMAT_BUFSIZE, "%.*f", precision,
+            value);
+    }
+
+    // Round to the requested number of places; nearbyint() rounds ties to
+    // even like printf does for exactly representable ties. Without decimal
+    // places, the last digit kept belongs to the integer part, so round that.
+    double scale = powersOf10[precision];
+    double intPart = (precision == 0) ? nearbyint(absVal) : std::floor(absVal);
+    double fracPart = absVal - intPart; // Exact
+    double scaled = fracPart * scale;
+    double frac = nearbyint(scaled);
+
+    // Scaling may round a value just below or above a tie onto it; the exact
+    // residual of the product tells which way the unrounded value lies, so
+    // only true ties are rounded to even
+    if (scaled - std::floor(scaled) == 0.5)
+    {
+        double residual = fma(fracPart, scale, -scaled);
+        if (residual > 0.)
+        {
+            frac = std::floor(scaled) + 1.;
+        }
+        else if (residual < 0.)
+        {
+            frac = std::floor(scaled);
+        }
+    }
+
+    if (frac >= scale)
+    {
+        intPart += 1.;
+        frac -= scale;
+    }
+
+    // Like printf, keep the sign of -0 and of negatives that round to zero
+    int n = 0;
+    if (std::signbit(value))
+    {
+        buf[n++] = '-';
+    }
+
+    n += writeDigits(static_cast<unsigned long long>(intPart), 1, buf + n);
+
+    if (precision > 0)
+    {
+        buf[n++] = '.';
+        n += writeDigits(static_cast<unsigned long long>(frac), precision,
+            buf + n);
+    }
+
+    buf[n] = '\0';
+    return n;
+}
+
+
+} // namespace gw1k
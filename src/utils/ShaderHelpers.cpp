@@ -0,0 +1,88 @@
+#include "utils/ShaderHelpers.h"
+
+#include "Log.h"
+
+#include <vector>
+
+namespace gw1k
+{
+
+
+namespace
+{
+
+
+GLuint
+compileShader(GLenum type, const char* src, const char* who)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src, 0);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length + 1, '\0');
+        glGetShaderInfoLog(shader, length, 0, &log[0]);
+        Log::error(who, Log::os() << "Shader compilation failed: " << &log[0]);
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+
+} // namespace
+
+
+GLuint
+createShaderProgram(
+    const char* vertexSrc,
+    const char* fragmentSrc,
+    const char* who)
+{
+    if (!GLEW_VERSION_2_0)
+    {
+        return 0;
+    }
+
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexSrc, who);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentSrc, who);
+    if (!vs || !fs)
+    {
+        if (vs) glDeleteShader(vs);
+        if (fs) glDeleteShader(fs);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+
+    // The program keeps the shaders alive as long as it needs them
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length + 1, '\0');
+        glGetProgramInfoLog(program, length, 0, &log[0]);
+        Log::error(who, Log::os() << "Shader linking failed: " << &log[0]);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+
+} // namespace gw1k
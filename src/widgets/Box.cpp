@@ -1,6 +1,7 @@
 #include "widgets/Box.h"
 
 #include "WManager.h"
+#include "MemoryReport.h"
 
 #include <GL/glew.h>
 
@@ -51,4 +52,12 @@ Box::renderBg(const Point& offset) const
 }
 
 
+void
+Box::accountMemory(MemoryFootprint& f) const
+{
+    Renderable::accountMemory(f);
+    f.object = sizeof(*this);
+}
+
+
 } // namespace gw1k
@@ -3,6 +3,7 @@
 #include <Point2D.h>
 #include "ThemeManager.h"
 #include "Render.h"
+#include "MemoryReport.h"
 
 #include <algorithm>
 
@@ -39,6 +40,12 @@ public:
         }
     };
 
+    virtual void accountMemory(MemoryFootprint& f) const
+    {
+        WiBox::accountMemory(f);
+        f.object = sizeof(*this);
+    };
+
 private:
 
     const CheckBox* checkBox_;
@@ -122,6 +129,7 @@ CheckBox::setColors(const char* colorScheme)
 
     std::string baseName(colorScheme ? colorScheme : "CheckBox");
     t->setColors(this, colorScheme, "CheckBox");
+    setStyle(colorScheme, "CheckBox");
     label_->setColors((baseName + ".Label").c_str());
     checkField_->setColors((baseName + ".CheckField").c_str());
 }
@@ -150,4 +158,12 @@ CheckBox::mouseClicked(
 }
 
 
+void
+CheckBox::accountMemory(MemoryFootprint& f) const
+{
+    WiBox::accountMemory(f);
+    f.object = sizeof(*this);
+}
+
+
 } // namespace gw1k
@@ -1,10 +1,14 @@
 #include "widgets/ClippingBox.h"
 
 #include "WManager.h"
+#include "RenderPipeline.h"
 #include "ThemeManager.h"
+#include "Log.h"
+#include "MemoryReport.h"
 
 #include <GL/glew.h>
 
+#include <cstdlib>
 #include <iostream>
 
 namespace gw1k
@@ -21,12 +25,21 @@ ClippingBox::ClippingBox(
     realOrigin_(0, 0),
     realSize_(size),
     subObjAccommodationStatus_(1, 1),
-    autoAdjustSize_(autoAdjustSize)
-{}
+    autoAdjustSize_(autoAdjustSize),
+    bScrollCaching_(false),
+    bCacheUnsupported_(false),
+    bCacheValid_(false),
+    currentCache_(0)
+{
+    cacheTex_[0] = cacheTex_[1] = 0;
+    cacheFbos_[0] = cacheFbos_[1] = 0;
+}
 
 
 ClippingBox::~ClippingBox()
-{}
+{
+    deleteCache();
+}
 
 
 const Point&
@@ -81,12 +94,12 @@ ClippingBox::getRealOrigin() const
 void
 ClippingBox::renderSubObjects(const Point& offset) const
 {
-    if (subObjects_.size() != 0)
+    if ((subObjects_.size() != 0) && !(bScrollCaching_ && renderCached(offset)))
     {
-        glPushMatrix();
+        pushTransform();
         {
             Point p = realOrigin_ + clippingOffset_;
-            glTranslatef(-p.x, -p.y, 0.f);
+            translateTransform(-p.x, -p.y);
 
             WManager::getInstance()->pushGlScissorOffset(p);
 
@@ -96,7 +109,7 @@ ClippingBox::renderSubObjects(const Point& offset) const
 
             WManager::getInstance()->popGlScissorOffset();
         }
-        glPopMatrix();
+        popTransform();
     }
 }
 
@@ -109,29 +122,8 @@ ClippingBox::addSubObject(GuiObject* o)
         autoAdjustSubObj(o);
     }
 
-    Point realEnd = realOrigin_ + realSize_;
-
-    Point newRealOrigin(min(o->getPos(), realOrigin_));
-    Point newRealSize = Point(max(getEnd(), max(o->getEnd(), realEnd))) - newRealOrigin;
-
-    if (autoAdjustSize_ == ScrollPane::ADJUST_WIDTH)
-    {
-        newRealOrigin.x = 0;
-        newRealSize.x = getSize().x;
-    }
-    else if (autoAdjustSize_ == ScrollPane::ADJUST_HEIGHT)
-    {
-        newRealOrigin.y = 0;
-        newRealSize.y = getSize().y;
-    }
-
-    // Keep viewing window at its position
-    clippingOffset_ += realOrigin_ - newRealOrigin;
-
-    realOrigin_ = newRealOrigin;
-    realSize_ = newRealSize;
-
-    checkAccommodation();
+    insertEdges(o);
+    updateRealBounds();
 
     GuiObject::addSubObject(o);
     o->setParent(this->parent_);
@@ -142,7 +134,8 @@ void
 ClippingBox::removeSubObject(GuiObject* o)
 {
     GuiObject::removeSubObject(o);
-    recalculateBounds();
+    eraseEdges(o);
+    updateRealBounds();
 
     // Keep viewing window within bounding box of all sub-widgets
     clippingOffset_ = max(clippingOffset_, realOrigin_);
@@ -150,6 +143,37 @@ ClippingBox::removeSubObject(GuiObject* o)
 }
 
 
+void
+ClippingBox::removeSubObjects(const std::vector<GuiObject*>& objects)
+{
+    GuiObject::removeSubObjects(objects);
+    for (unsigned int i = 0; i != objects.size(); ++i)
+    {
+        eraseEdges(objects[i]);
+    }
+    updateRealBounds();
+
+    clippingOffset_ = max(clippingOffset_, realOrigin_);
+    clippingOffset_ = min(clippingOffset_, realOrigin_ + realSize_ - getSize());
+}
+
+
+void
+ClippingBox::removeAndDeleteAllSubObjects()
+{
+    GuiObject::removeAndDeleteAllSubObjects();
+    subObjBounds_.clear();
+    left_.clear();
+    top_.clear();
+    right_.clear();
+    bottom_.clear();
+    updateRealBounds();
+
+    clippingOffset_ = max(clippingOffset_, realOrigin_);
+    clippingOffset_ = min(clippingOffset_, realOrigin_ + realSize_ - getSize());
+}
+
+
 GuiObject*
 ClippingBox::getContainingObject(const Point& p)
 {
@@ -174,34 +198,34 @@ ClippingBox::containsMouse(const Point& p) const
 
 
 void
-ClippingBox::recalculateBounds()
+ClippingBox::updateSubObjectBounds(GuiObject* o)
 {
-    Point minPos = realOrigin_ + realSize_;
-    Point maxPos = realOrigin_;
-    Point oldRealOrigin = realOrigin_;
-
-    for (unsigned int i = 0; i != subObjects_.size(); ++i)
+    // Inserting the edges of a foreign object would inflate the bounds for
+    // good, since nothing would ever erase them
+    if (!eraseEdges(o))
     {
-        GuiObject* q = subObjects_[i];
-        const Point& pos = q->getPos();
-        const Point& end = q->getEnd();
-
-        if (pos.x < minPos.x) minPos.x = pos.x;
-        if (pos.y < minPos.y) minPos.y = pos.y;
-        if (end.x > maxPos.x) maxPos.x = end.x;
-        if (end.y > maxPos.y) maxPos.y = end.y;
+        Log::warning("ClippingBox", Log::os() << "Attempt to update bounds of "
+            << (void*)o << ", which is not a sub-object");
+        return;
     }
+    insertEdges(o);
+    updateRealBounds();
+}
 
-    // Keep viewing window at its position
-    clippingOffset_ += oldRealOrigin - realOrigin_;
-
-    const Point& boxEnd = getEnd();
-
-    // Don't let things get smaller than the visible window
-    realOrigin_ = min(minPos, Point(0, 0));
-    realSize_ = max(maxPos, boxEnd) - realOrigin_;
 
-    checkAccommodation();
+void
+ClippingBox::recalculateBounds()
+{
+    subObjBounds_.clear();
+    left_.clear();
+    top_.clear();
+    right_.clear();
+    bottom_.clear();
+    for (unsigned int i = 0; i != subObjects_.size(); ++i)
+    {
+        insertEdges(subObjects_[i]);
+    }
+    updateRealBounds();
 }
 
 
@@ -219,6 +243,31 @@ ClippingBox::getAutoAdjustSize() const
 }
 
 
+void
+ClippingBox::setScrollCaching(bool enabled)
+{
+    bScrollCaching_ = enabled;
+    if (!enabled)
+    {
+        deleteCache();
+    }
+}
+
+
+bool
+ClippingBox::isScrollCaching() const
+{
+    return bScrollCaching_;
+}
+
+
+void
+ClippingBox::invalidateScrollCache()
+{
+    bCacheValid_ = false;
+}
+
+
 void
 ClippingBox::checkAccommodation()
 {
@@ -233,7 +282,10 @@ ClippingBox::autoAdjustSubObjs()
 {
     for (unsigned int i = 0; i != subObjects_.size(); ++i)
     {
-        autoAdjustSubObj(subObjects_[i]);
+        GuiObject* o = subObjects_[i];
+        autoAdjustSubObj(o);
+        eraseEdges(o);
+        insertEdges(o);
     }
 }
 
@@ -272,4 +324,350 @@ ClippingBox::autoAdjustSubObj(GuiObject* o)
 }
 
 
+void
+ClippingBox::insertEdges(GuiObject* o)
+{
+    const Point& pos = o->getPos();
+    const Point& end = o->getEnd();
+    subObjBounds_[o] = Rect(pos, o->getSize());
+    left_.insert(pos.x);
+    top_.insert(pos.y);
+    right_.insert(end.x);
+    bottom_.insert(end.y);
+}
+
+
+bool
+ClippingBox::eraseEdges(const GuiObject* o)
+{
+    std::map<const GuiObject*, Rect>::iterator it = subObjBounds_.find(o);
+    if (it == subObjBounds_.end())
+    {
+        return false;
+    }
+
+    const Point& pos = it->second.pos();
+    const Point& end = it->second.end();
+    left_.erase(left_.find(pos.x));
+    top_.erase(top_.find(pos.y));
+    right_.erase(right_.find(end.x));
+    bottom_.erase(bottom_.find(end.y));
+    subObjBounds_.erase(it);
+    return true;
+}
+
+
+void
+ClippingBox::updateRealBounds()
+{
+    // Don't let things get smaller than the visible window
+    Point newRealOrigin(0, 0);
+    Point newRealEnd = getEnd();
+    if (!left_.empty())
+    {
+        newRealOrigin = min(newRealOrigin, Point(*left_.begin(), *top_.begin()));
+        newRealEnd = max(newRealEnd, Point(*right_.rbegin(), *bottom_.rbegin()));
+    }
+    Point newRealSize = newRealEnd - newRealOrigin;
+
+    if (autoAdjustSize_ == ScrollPane::ADJUST_WIDTH)
+    {
+        newRealOrigin.x = 0;
+        newRealSize.x = getSize().x;
+    }
+    else if (autoAdjustSize_ == ScrollPane::ADJUST_HEIGHT)
+    {
+        newRealOrigin.y = 0;
+        newRealSize.y = getSize().y;
+    }
+
+    // Keep viewing window at its position
+    clippingOffset_ += realOrigin_ - newRealOrigin;
+
+    realOrigin_ = newRealOrigin;
+    realSize_ = newRealSize;
+
+    checkAccommodation();
+    bCacheValid_ = false;
+}
+
+
+bool
+ClippingBox::renderCached(const Point& offset) const
+{
+    if (!createCache())
+    {
+        return false;
+    }
+
+    WManager* wm = WManager::getInstance();
+    const Point& size = getSize();
+    Point pos = getPos() + offset;
+    Point winPos = pos - wm->getGlScissorOffset();
+    Point view = realOrigin_ + clippingOffset_;
+    Point delta = view - cachedView_;
+
+    bool bFull = !bCacheValid_ || (winPos != cachedWinPos_)
+        || (std::abs(delta.x) >= size.x) || (std::abs(delta.y) >= size.y);
+
+    if (bFull || (delta != Point()))
+    {
+        GLint prevFbo;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+        glPushAttrib(GL_VIEWPORT_BIT | GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT
+            | GL_SCISSOR_BIT | GL_CURRENT_BIT | GL_TEXTURE_BIT);
+
+        // A shift copies from one texture to the other, since a texture cannot
+        // be read while rendering to it
+        int target = bFull ? currentCache_ : (1 - currentCache_);
+        glBindFramebuffer(GL_FRAMEBUFFER, cacheFbos_[target]);
+        if (!bFull)
+        {
+            shiftCache(currentCache_, delta);
+        }
+
+        // Map window pixels to cache pixels: the cache's origin is the bottom
+        // left pixel of the ClippingBox
+        const Point& winSize = wm->getWindowSize();
+        Point origin(winPos.x, winSize.y - winPos.y - size.y);
+        glViewport(-origin.x, -origin.y, winSize.x, winSize.y);
+        wm->pushGlScissorOrigin(origin);
+
+        // Accumulate premultiplied colours over a transparent background, so
+        // the cache can be blended like the content would have been
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
+            GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glClearColor(0.f, 0.f, 0.f, 0.f);
+
+        if (bFull)
+        {
+            renderStrip(offset, Point(), size);
+        }
+        else
+        {
+            // Content moves by -delta, exposing strips at the leading edges
+            if (delta.x != 0)
+            {
+                renderStrip(offset, Point(delta.x > 0 ? size.x - delta.x : 0, 0),
+                    Point(std::abs(delta.x), size.y));
+            }
+            if (delta.y != 0)
+            {
+                renderStrip(offset, Point(0, delta.y > 0 ? size.y - delta.y : 0),
+                    Point(size.x, std::abs(delta.y)));
+            }
+        }
+
+        wm->popGlScissorOrigin();
+        glBindFramebuffer(GL_FRAMEBUFFER, prevFbo);
+        glPopAttrib();
+
+        currentCache_ = target;
+        cachedView_ = view;
+        cachedWinPos_ = winPos;
+        bCacheValid_ = true;
+    }
+
+    syncFixedFunctionTransform();
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT
+        | GL_TEXTURE_BIT);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, cacheTex_[currentCache_]);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glColor4f(1.f, 1.f, 1.f, 1.f);
+    Point end = pos + size;
+    glBegin(GL_QUADS);
+    {
+        glTexCoord2f(0.f, 1.f);
+        glVertex2i(pos.x, pos.y);
+        glTexCoord2f(1.f, 1.f);
+        glVertex2i(end.x, pos.y);
+        glTexCoord2f(1.f, 0.f);
+        glVertex2i(end.x, end.y);
+        glTexCoord2f(0.f, 0.f);
+        glVertex2i(pos.x, end.y);
+    }
+    glEnd();
+    glPopAttrib();
+
+    return true;
+}
+
+
+void
+ClippingBox::renderStrip(
+    const Point& offset,
+    const Point& stripPos,
+    const Point& stripSize) const
+{
+    WManager* wm = WManager::getInstance();
+    wm->pushGlScissor(getPos() + offset + stripPos, stripSize);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    pushTransform();
+    {
+        Point p = realOrigin_ + clippingOffset_;
+        translateTransform(-p.x, -p.y);
+        wm->pushGlScissorOffset(p);
+
+        // Skip sub-objects outside the strip
+        Point from = p + stripPos;
+        Point to = from + stripSize;
+        Point subObjOffset = offset + getPos();
+        for (unsigned int i = 0; i != subObjects_.size(); ++i)
+        {
+            const GuiObject* o = subObjects_[i];
+            const Point& oPos = o->getPos();
+            const Point& oEnd = o->getEnd();
+            if ((oPos.x < to.x) && (oPos.y < to.y) && (oEnd.x > from.x)
+                && (oEnd.y > from.y))
+            {
+                o->render(subObjOffset);
+            }
+        }
+
+        wm->popGlScissorOffset();
+    }
+    popTransform();
+
+    wm->popGlScissor();
+}
+
+
+void
+ClippingBox::shiftCache(int source, const Point& delta) const
+{
+    glDisable(GL_SCISSOR_TEST);
+    glDisable(GL_BLEND);
+    glViewport(0, 0, cacheSize_.x, cacheSize_.y);
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0., cacheSize_.x, 0., cacheSize_.y, -1., 1.);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, cacheTex_[source]);
+    glColor4f(1.f, 1.f, 1.f, 1.f);
+
+    // In cache pixels, y points up, so scrolling down moves content up
+    int x0 = -delta.x;
+    int y0 = delta.y;
+    glBegin(GL_QUADS);
+    {
+        glTexCoord2f(0.f, 0.f);
+        glVertex2i(x0, y0);
+        glTexCoord2f(1.f, 0.f);
+        glVertex2i(x0 + cacheSize_.x, y0);
+        glTexCoord2f(1.f, 1.f);
+        glVertex2i(x0 + cacheSize_.x, y0 + cacheSize_.y);
+        glTexCoord2f(0.f, 1.f);
+        glVertex2i(x0, y0 + cacheSize_.y);
+    }
+    glEnd();
+
+    glDisable(GL_TEXTURE_2D);
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+
+    glEnable(GL_BLEND);
+    glEnable(GL_SCISSOR_TEST);
+}
+
+
+bool
+ClippingBox::createCache() const
+{
+    const Point& size = getSize();
+    if (bCacheUnsupported_ || (size.x <= 0) || (size.y <= 0))
+    {
+        return false;
+    }
+    if (cacheFbos_[0] && (size == cacheSize_))
+    {
+        return true;
+    }
+
+    if (!cacheFbos_[0])
+    {
+        if (!GLEW_ARB_framebuffer_object || !GLEW_VERSION_1_4)
+        {
+            Log::warning("ClippingBox", "Scroll caching requires framebuffer "
+                "objects, rendering without cache");
+            bCacheUnsupported_ = true;
+            return false;
+        }
+        glGenTextures(2, cacheTex_);
+        glGenFramebuffers(2, cacheFbos_);
+    }
+
+    GLint prevFbo;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    bool bComplete = true;
+    for (int i = 0; i != 2; ++i)
+    {
+        glBindTexture(GL_TEXTURE_2D, cacheTex_[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA,
+            GL_UNSIGNED_BYTE, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, cacheFbos_[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+            GL_TEXTURE_2D, cacheTex_[i], 0);
+        bComplete = bComplete && (glCheckFramebufferStatus(GL_FRAMEBUFFER)
+            == GL_FRAMEBUFFER_COMPLETE);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, prevFbo);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    cacheSize_ = size;
+    bCacheValid_ = false;
+
+    if (!bComplete)
+    {
+        Log::warning("ClippingBox", "Scroll cache framebuffer incomplete, "
+            "rendering without cache");
+        bCacheUnsupported_ = true;
+        return false;
+    }
+    return true;
+}
+
+
+void
+ClippingBox::deleteCache()
+{
+    if (cacheFbos_[0])
+    {
+        glDeleteFramebuffers(2, cacheFbos_);
+        glDeleteTextures(2, cacheTex_);
+        cacheFbos_[0] = cacheFbos_[1] = 0;
+        cacheTex_[0] = cacheTex_[1] = 0;
+    }
+    bCacheValid_ = false;
+}
+
+
+void
+ClippingBox::accountMemory(MemoryFootprint& f) const
+{
+    Box::accountMemory(f);
+    f.object = sizeof(*this);
+    f.buffers += getHeapSize(subObjBounds_) + getHeapSize(left_)
+        + getHeapSize(top_) + getHeapSize(right_) + getHeapSize(bottom_);
+    if (cacheTex_[0])
+    {
+        f.gpu += 2 * cacheSize_.x * cacheSize_.y * 4;
+    }
+}
+
+
 } // namespace gw1k
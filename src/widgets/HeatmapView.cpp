@@ -0,0 +1,416 @@
+#include "widgets/HeatmapView.h"
+
+#include "utils/ShaderHelpers.h"
+#include "Render.h"
+#include "MemoryReport.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gw1k
+{
+
+
+namespace
+{
+
+
+const char* VERTEX_SHADER =
+    "void main()\n"
+    "{\n"
+    "    gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+    "    gl_FrontColor = gl_Color;\n"
+    "    gl_Position = ftransform();\n"
+    "}\n";
+
+
+// Maps the quantised value to the centre of the corresponding colour map texel
+const char* FRAGMENT_SHADER =
+    "uniform sampler2D values;\n"
+    "uniform sampler1D colorMap;\n"
+    "void main()\n"
+    "{\n"
+    "    float v = texture2D(values, gl_TexCoord[0].st).r;\n"
+    "    gl_FragColor = gl_Color\n"
+    "        * texture1D(colorMap, v * (255.0 / 256.0) + 0.5 / 256.0);\n"
+    "}\n";
+
+
+} // namespace
+
+
+HeatmapView::HeatmapView(
+    const Point& pos,
+    const Point& size,
+    int columns,
+    int rows,
+    const char* shadeColorScheme)
+:   OGLView(pos, size, shadeColorScheme),
+    columns_(std::max(1, columns)),
+    rows_(std::max(1, rows)),
+    head_(0),
+    minValue_(0.f),
+    valueScale_(255.f),
+    values_(columns_ * rows_, 0),
+    colorMap_(256 * 4, 0),
+    bUsePixelBuffers_(false),
+    bTexturesCreated_(false),
+    valueTex_(0),
+    colorMapTex_(0),
+    program_(0),
+    nextPbo_(0)
+{
+    pbos_[0] = pbos_[1] = 0;
+
+    std::vector<Color4i> heat;
+    heat.push_back(Color4i(0, 0, 0));
+    heat.push_back(Color4i(0, 0, 255));
+    heat.push_back(Color4i(255, 0, 0));
+    heat.push_back(Color4i(255, 255, 0));
+    heat.push_back(Color4i(255, 255, 255));
+    setColorMap(heat);
+}
+
+
+HeatmapView::~HeatmapView()
+{
+    if (bTexturesCreated_)
+    {
+        glDeleteTextures(1, &valueTex_);
+        if (colorMapTex_)
+        {
+            glDeleteTextures(1, &colorMapTex_);
+        }
+        if (program_)
+        {
+            glDeleteProgram(program_);
+        }
+        if (pbos_[0])
+        {
+            glDeleteBuffersARB(2, pbos_);
+        }
+    }
+}
+
+
+int
+HeatmapView::getColumns() const
+{
+    return columns_;
+}
+
+
+int
+HeatmapView::getRows() const
+{
+    return rows_;
+}
+
+
+void
+HeatmapView::setValueRange(float min, float max)
+{
+    minValue_ = min;
+    valueScale_ = (max != min) ? 255.f / (max - min) : 0.f;
+}
+
+
+void
+HeatmapView::setColorMap(const std::vector<Color4i>& colors)
+{
+    if (colors.empty())
+    {
+        return;
+    }
+
+    for (int i = 0; i != 256; ++i)
+    {
+        const Color4i* c0 = &colors[0];
+        const Color4i* c1 = c0;
+        float f = 0.f;
+        if (colors.size() > 1)
+        {
+            float t = i / 255.f * (colors.size() - 1);
+            unsigned int k = std::min<unsigned int>(t, colors.size() - 2);
+            c0 = &colors[k];
+            c1 = &colors[k + 1];
+            f = t - k;
+        }
+
+        unsigned char* dst = &colorMap_[4 * i];
+        dst[0] = static_cast<unsigned char>(c0->r + f * (c1->r - c0->r) + .5f);
+        dst[1] = static_cast<unsigned char>(c0->g + f * (c1->g - c0->g) + .5f);
+        dst[2] = static_cast<unsigned char>(c0->b + f * (c1->b - c0->b) + .5f);
+        dst[3] = static_cast<unsigned char>(c0->a + f * (c1->a - c0->a) + .5f);
+    }
+
+    if (bTexturesCreated_)
+    {
+        if (program_)
+        {
+            uploadColorMap();
+        }
+        else
+        {
+            // Colours are baked into the texture
+            uploadRect(0, 0, columns_, rows_);
+        }
+    }
+}
+
+
+void
+HeatmapView::appendRow(const float* values)
+{
+    // Overwrite the oldest row (which uploads it), then move the ring's start
+    // past it so it becomes the newest
+    setValues(0, 0, columns_, 1, values);
+    head_ = (head_ + 1) % rows_;
+}
+
+
+void
+HeatmapView::setValues(int x, int y, int w, int h, const float* values)
+{
+    // Clip to the grid, keeping track of the offset into values
+    int stride = w;
+    if (x < 0) { values -= x; w += x; x = 0; }
+    if (y < 0) { values -= y * stride; h += y; y = 0; }
+    w = std::min(w, columns_ - x);
+    h = std::min(h, rows_ - y);
+    if ((w <= 0) || (h <= 0))
+    {
+        return;
+    }
+
+    for (int i = 0; i != h; ++i)
+    {
+        const float* src = values + i * stride;
+        unsigned char* dst = &values_[textureRow(y + i) * columns_ + x];
+        for (int j = 0; j != w; ++j)
+        {
+            float v = (src[j] - minValue_) * valueScale_;
+            dst[j] = static_cast<unsigned char>(
+                std::max(0.f, std::min(255.f, v)) + .5f);
+        }
+    }
+
+    if (bTexturesCreated_)
+    {
+        // The logical rows may wrap around the end of the texture
+        int row = textureRow(y);
+        int h0 = std::min(h, rows_ - row);
+        uploadRect(x, row, w, h0);
+        if (h0 < h)
+        {
+            uploadRect(x, 0, w, h - h0);
+        }
+    }
+}
+
+
+void
+HeatmapView::setUsePixelBuffers(bool enabled)
+{
+    bUsePixelBuffers_ = enabled;
+}
+
+
+void
+HeatmapView::renderOGLContent() const
+{
+    if (!bTexturesCreated_)
+    {
+        createTextures();
+    }
+
+    Color4i* shadeCol, *foo;
+    shadeColorTable_.queryColors(shadeCol, foo, this);
+    setGLColor(shadeCol);
+
+    if (program_)
+    {
+        glUseProgram(program_);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_1D, colorMapTex_);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, valueTex_);
+    glPushMatrix();
+    {
+        float m = 1.f / std::min(columns_, rows_);
+        glScalef(columns_ * m, rows_ * m, 1.f);
+
+        // The oldest row is at the top; texture coordinates beyond 1 wrap
+        // around to the start of the ring
+        float t0 = static_cast<float>(head_) / rows_;
+        glBegin(GL_QUADS);
+        {
+            glTexCoord2f(0.f, t0 + 1.f);
+            glVertex3f(-1.f, -1.f, 0.f);
+            glTexCoord2f(0.f, t0);
+            glVertex3f(-1.f, 1.f, 0.f);
+            glTexCoord2f(1.f, t0);
+            glVertex3f(1.f, 1.f, 0.f);
+            glTexCoord2f(1.f, t0 + 1.f);
+            glVertex3f(1.f, -1.f, 0.f);
+        }
+        glEnd();
+    }
+    glPopMatrix();
+    glDisable(GL_TEXTURE_2D);
+
+    if (program_)
+    {
+        glUseProgram(0);
+    }
+}
+
+
+void
+HeatmapView::createTextures() const
+{
+    bTexturesCreated_ = true;
+
+    program_ = createShaderProgram(VERTEX_SHADER, FRAGMENT_SHADER,
+        "HeatmapView");
+    if (program_)
+    {
+        glUseProgram(program_);
+        glUniform1i(glGetUniformLocation(program_, "values"), 0);
+        glUniform1i(glGetUniformLocation(program_, "colorMap"), 1);
+        glUseProgram(0);
+
+        glGenTextures(1, &colorMapTex_);
+        glBindTexture(GL_TEXTURE_1D, colorMapTex_);
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA8, 256, 0, GL_RGBA,
+            GL_UNSIGNED_BYTE, 0);
+        uploadColorMap();
+    }
+
+    // The texture is allocated once here; all later changes are uploaded with
+    // glTexSubImage2D()
+    glGenTextures(1, &valueTex_);
+    glBindTexture(GL_TEXTURE_2D, valueTex_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, program_ ? GL_LUMINANCE8 : GL_RGBA8,
+        columns_, rows_, 0, program_ ? GL_LUMINANCE : GL_RGBA,
+        GL_UNSIGNED_BYTE, 0);
+    uploadRect(0, 0, columns_, rows_);
+}
+
+
+void
+HeatmapView::uploadColorMap() const
+{
+    glBindTexture(GL_TEXTURE_1D, colorMapTex_);
+    glTexSubImage1D(GL_TEXTURE_1D, 0, 0, 256, GL_RGBA, GL_UNSIGNED_BYTE,
+        &colorMap_[0]);
+}
+
+
+void
+HeatmapView::uploadRect(int x, int row, int w, int h) const
+{
+    // With shaders, quantised values are uploaded and the colour map is applied
+    // when rendering; otherwise, the colours are looked up here
+    int texelSize = program_ ? 1 : 4;
+    unsigned int size = w * h * texelSize;
+
+    bool bPbo = bUsePixelBuffers_ && GLEW_ARB_pixel_buffer_object;
+    unsigned char* dst = 0;
+    if (bPbo)
+    {
+        if (!pbos_[0])
+        {
+            glGenBuffersARB(2, pbos_);
+        }
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, pbos_[nextPbo_]);
+        nextPbo_ ^= 1;
+
+        // Orphan the previous data store, so mapping doesn't wait for a pending
+        // transfer from it
+        glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, size, 0, GL_STREAM_DRAW_ARB);
+        dst = static_cast<unsigned char*>(
+            glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB));
+        if (!dst)
+        {
+            glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+            bPbo = false;
+        }
+    }
+    if (!bPbo)
+    {
+        uploadBuf_.resize(size);
+        dst = &uploadBuf_[0];
+    }
+
+    for (int i = 0; i != h; ++i)
+    {
+        const unsigned char* src = &values_[(row + i) * columns_ + x];
+        if (program_)
+        {
+            std::memcpy(dst + i * w, src, w);
+        }
+        else
+        {
+            unsigned char* d = dst + i * w * 4;
+            for (int j = 0; j != w; ++j)
+            {
+                std::memcpy(d + j * 4, &colorMap_[src[j] * 4], 4);
+            }
+        }
+    }
+
+    if (bPbo)
+    {
+        glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+        dst = 0; // Offset into the bound buffer
+    }
+
+    glBindTexture(GL_TEXTURE_2D, valueTex_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, row, w, h,
+        program_ ? GL_LUMINANCE : GL_RGBA, GL_UNSIGNED_BYTE, dst);
+
+    if (bPbo)
+    {
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+    }
+}
+
+
+int
+HeatmapView::textureRow(int y) const
+{
+    return (head_ + y) % rows_;
+}
+
+
+void
+HeatmapView::accountMemory(MemoryFootprint& f) const
+{
+    OGLView::accountMemory(f);
+    f.object = sizeof(*this);
+    f.buffers += getHeapSize(values_) + getHeapSize(colorMap_)
+        + getHeapSize(uploadBuf_);
+    if (valueTex_)
+    {
+        f.gpu += columns_ * rows_ * (program_ ? 1 : 4);
+    }
+    if (colorMapTex_)
+    {
+        f.gpu += colorMap_.size();
+    }
+}
+
+
+} // namespace gw1k
@@ -5,6 +5,8 @@
 #include "MathHelper.h"
 #include "Color4i.h"
 #include "ThemeManager.h"
+#include "WManager.h"
+#include "MemoryReport.h"
 
 #include <iostream>
 
@@ -26,7 +28,10 @@ Label::Label(
     bAutoSized_(autoSize),
     text_(padding_, text),
     bVCenterVisually_(false),
-    lineLength_(-1)
+    lineLength_(-1),
+    bLatchedUpdates_(false),
+    bTextPending_(false),
+    bPreRenderUpdateRequested_(false)
 {
     int faceSize = calculateFaceSize(Gw1kSettings::defaultFontSize);
     text_.setFont(Gw1kSettings::defaultFontName, faceSize);
@@ -109,6 +114,60 @@ Label::setWrapText(bool wrap)
 
 void
 Label::setText(const std::string& text)
+{
+    if (bLatchedUpdates_)
+    {
+        pendingText_ = text;
+        bTextPending_ = true;
+        requestPreRenderUpdate();
+    }
+    else
+    {
+        applyText(text);
+    }
+}
+
+
+const std::string&
+Label::getText() const
+{
+    return bTextPending_ ? pendingText_ : text_.getText();
+}
+
+
+void
+Label::setLatchedUpdates(bool state)
+{
+    bLatchedUpdates_ = state;
+    if (!state)
+    {
+        preRenderUpdate();
+    }
+}
+
+
+bool
+Label::hasLatchedUpdates() const
+{
+    return bLatchedUpdates_;
+}
+
+
+void
+Label::preRenderUpdate()
+{
+    bPreRenderUpdateRequested_ = false;
+
+    if (bTextPending_)
+    {
+        bTextPending_ = false;
+        applyText(pendingText_);
+    }
+}
+
+
+void
+Label::applyText(const std::string& text)
 {
     text_.setText(text);
 
@@ -125,10 +184,14 @@ Label::setText(const std::string& text)
 }
 
 
-const std::string&
-Label::getText() const
+void
+Label::requestPreRenderUpdate()
 {
-    return text_.getText();
+    if (!bPreRenderUpdateRequested_)
+    {
+        bPreRenderUpdateRequested_ = true;
+        WManager::getInstance()->registerForPreRenderUpdate(this);
+    }
 }
 
 
@@ -271,6 +334,37 @@ Label::updateWrappedTextLayout()
 }
 
 
+int
+Label::getTextProperties() const
+{
+    return textProps_;
+}
+
+
+int
+Label::getLineLength() const
+{
+    return lineLength_;
+}
+
+
+void
+Label::restoreTextLayout(const TextLayout& layout, int lineLength)
+{
+    lineLength_ = lineLength;
+    text_.restoreLayout(layout);
+
+    if (bAutoSized_)
+    {
+        adaptToTextSize();
+    }
+    else
+    {
+        updateTextAlignment();
+    }
+}
+
+
 Text&
 Label::getTextWidget()
 {
@@ -278,6 +372,13 @@ Label::getTextWidget()
 }
 
 
+const Text&
+Label::getTextWidget() const
+{
+    return text_;
+}
+
+
 void
 Label::mouseMoved(
     MouseMovedEvent ev,
@@ -397,8 +498,19 @@ Label::setColors(const char* colorScheme)
 
     std::string baseName(colorScheme ? colorScheme : "Label");
     t->setColors(this, colorScheme, "Label");
+    setStyle(colorScheme, "Label");
     text_.setColors((baseName + ".Text").c_str());
 }
 
 
+void
+Label::accountMemory(MemoryFootprint& f) const
+{
+    WiBox::accountMemory(f);
+    f.object = sizeof(*this);
+    // textBox_ and text_ are sub-objects and account for themselves
+    f.text += getHeapSize(pendingText_);
+}
+
+
 } // namespace gw1k
@@ -1,5 +1,7 @@
 #include "widgets/Menu.h"
 
+#include "MemoryReport.h"
+
 namespace gw1k
 {
 
@@ -148,6 +150,7 @@ void
 Menu::setColors(const char* colorScheme)
 {
     sColorScheme_ = colorScheme ? colorScheme : "Menu";
+    // Also applies the scheme's style, as the name passed is never 0
     super::setColors(sColorScheme_.c_str());
 
     sEntryColorScheme_ = std::string(sColorScheme_ + ".Entry");
@@ -209,4 +212,14 @@ Menu::repositionEntriesAndResize()
 }
 
 
+void
+Menu::accountMemory(MemoryFootprint& f) const
+{
+    WiBox::accountMemory(f);
+    f.object = sizeof(*this);
+    f.listeners += getHeapSize(actionListeners_) + getHeapSize(entries_);
+    f.text += getHeapSize(sColorScheme_) + getHeapSize(sEntryColorScheme_);
+}
+
+
 } // namespace gw1k
@@ -1,9 +1,11 @@
 #include "widgets/OGLView.h"
 
 #include "Render.h"
+#include "RenderPipeline.h"
 #include "utils/Helpers.h"
 #include "MathHelper.h"
 #include "ThemeManager.h"
+#include "MemoryReport.h"
 
 #include <GL/glew.h>
 
@@ -149,37 +151,40 @@ OGLView::allowMouseControl(bool state)
 void
 OGLView::renderContent(const Point& offset) const
 {
-    glPushMatrix();
+    pushTransform();
     {
         // TODO Actually, we should undo the glTranslatef(0.375f, 0.375f, 0.f)
         // from GLFWApp here because this widget is not about pixel coordinates
 
         // Translate so GL coordinate (0,0) is at top-left corner of our widget
         Point pos = getPos() + offset;
-        glTranslatef(pos.x, pos.y, 0);
+        translateTransform(pos.x, pos.y);
 
         // Transform so GL coordinate (0,0) is in the center and the shorter
         // edge's size corresponds to the GL coordinate range [-1,1] (thus, the
         // longer edge will have a greater range, depending on the aspect ratio)
         const Point& size = getSize();
-        glScalef(0.5f * minDimSize_, -0.5f * minDimSize_, 1.f);
-        glTranslatef(size.x * widgToRelSize_.x, -size.y * widgToRelSize_.y, 0.f);
+        scaleTransform(0.5f * minDimSize_, -0.5f * minDimSize_);
+        translateTransform(size.x * widgToRelSize_.x,
+            -size.y * widgToRelSize_.y);
 
-        glPushMatrix();
+        pushTransform();
         {
             // Apply our transformations
-            glScalef(zoom_.x, zoom_.y, 1.f);
-            glTranslatef(transl_.x, transl_.y, 0.f);
+            scaleTransform(zoom_.x, zoom_.y);
+            translateTransform(transl_.x, transl_.y);
 
-            glPushMatrix();
+            // The content may use OpenGL's matrix stack directly
+            syncFixedFunctionTransform();
+            pushTransform();
             {
                 renderOGLContent();
             }
-            glPopMatrix();
+            popTransform();
         }
-        glPopMatrix();
+        popTransform();
     }
-    glPopMatrix();
+    popTransform();
 }
 
 
@@ -255,7 +260,8 @@ OGLView::renderOGLContent() const
 {
     // Render x and y axis and a 1x1-sized box starting at the (OpenGL) origin
     using namespace geom;
-    glColor4f(1.f, 0.f, 0.f, 0.33f);
+    Color4i fill(255, 0, 0, 84);
+    setGLColor(&fill);
     fillRect(Point2D(0.f, 0.f), Point2D(1.f, 1.f));
     glColor3f(1.f, 0.f, 0.f);
     glBegin(GL_LINES);
@@ -373,5 +379,14 @@ OGLView::updateInternalVars()
 
 }
 
+void
+OGLView::accountMemory(MemoryFootprint& f) const
+{
+    Box::accountMemory(f);
+    f.object = sizeof(*this);
+    f.addColors(shadeColorTable_);
+}
+
+
 } // namespace gw1k
 
@@ -1,5 +1,7 @@
 #include "widgets/OGLViewWiBox.h"
 
+#include "MemoryReport.h"
+
 
 namespace gw1k
 {
@@ -159,4 +161,12 @@ OGLViewWiBox::setShadeColorScheme(const char* colorScheme)
 }
 
 
+void
+OGLViewWiBox::accountMemory(MemoryFootprint& f) const
+{
+    WiBox::accountMemory(f);
+    f.object = sizeof(*this);
+}
+
+
 } // namespace gw1k
@@ -0,0 +1,697 @@
+#include "widgets/PlotView.h"
+
+#include "Render.h"
+#include "ThemeManager.h"
+#include "Exception.h"
+#include "Log.h"
+#include "MemoryReport.h"
+
+#include <GL/glfw.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace gw1k
+{
+
+
+namespace
+{
+
+
+const unsigned int CHUNK_BITS = 12;
+
+const unsigned long CHUNK_SIZE = 1UL << CHUNK_BITS;
+
+const unsigned long CHUNK_MASK = CHUNK_SIZE - 1;
+
+
+} // namespace
+
+
+PlotView::PlotView(
+    const Point& pos,
+    const Point& size,
+    unsigned long capacity,
+    const char* lineColorScheme)
+:   OGLView(pos, size),
+    ringChunks_(0),
+    first_(0),
+    end_(0),
+    dx_(0.001f),
+    extData_(0),
+    extStride_(1),
+    mappedData_(0),
+    mappedSize_(0),
+    ingested_(0),
+    rateStart_(glfwGetTime()),
+    rate_(0.0),
+    dirtyFrom_(0),
+    bVerticesDirect_(false),
+    verticesPxSamples_(0.0),
+    verticesStart_(-1.0),
+    verticesFirst_(0),
+    vbo_(0),
+    vboCapacity_(0)
+{
+    // One more chunk than needed for capacity, so at least capacity samples are
+    // kept when the oldest chunk is dropped
+    unsigned long numChunks = (capacity + CHUNK_MASK) / CHUNK_SIZE + 1;
+    chunks_.reserve(numChunks);
+    for (unsigned long i = 0; i != numChunks; ++i)
+    {
+        Chunk* c = new Chunk();
+        c->samples.resize(CHUNK_SIZE);
+        c->mins.resize(CHUNK_SIZE - 1);
+        c->maxs.resize(CHUNK_SIZE - 1);
+        chunks_.push_back(c);
+    }
+    ringChunks_ = numChunks;
+
+    allowMouseControl(true);
+    setLineColorScheme(lineColorScheme);
+}
+
+
+PlotView::~PlotView()
+{
+    if (vbo_)
+    {
+        glDeleteBuffersARB(1, &vbo_);
+    }
+    unmapSampleFile();
+    for (unsigned int i = 0; i != chunks_.size(); ++i)
+    {
+        delete chunks_[i];
+    }
+}
+
+
+void
+PlotView::addSample(float value)
+{
+    addSamples(&value, 1);
+}
+
+
+void
+PlotView::addSamples(
+    const float* values,
+    unsigned long n,
+    unsigned int stride)
+{
+    if (extData_)
+    {
+        throw Exception("PlotView::addSamples() called while external samples "
+            "are set");
+    }
+
+    samplesAdded(end_, n);
+
+    while (n > 0)
+    {
+        unsigned long pos = end_ & CHUNK_MASK;
+        if ((pos == 0) && (end_ - first_ == chunks_.size() * CHUNK_SIZE))
+        {
+            // All chunks in use; drop the oldest one, which will be reused
+            first_ += CHUNK_SIZE;
+        }
+
+        unsigned long m = std::min(n, CHUNK_SIZE - pos);
+        Chunk& c = chunkOf(end_);
+        if (stride == 1)
+        {
+            std::memcpy(&c.samples[pos], values, m * sizeof(float));
+        }
+        else
+        {
+            for (unsigned long i = 0; i != m; ++i)
+            {
+                c.samples[pos + i] = values[i * stride];
+            }
+        }
+        updatePyramid(c, &c.samples[0], 1, pos, pos + m);
+
+        end_ += m;
+        values += m * stride;
+        n -= m;
+    }
+}
+
+
+void
+PlotView::setExternalSamples(
+    const float* data,
+    unsigned long n,
+    unsigned int stride)
+{
+    bool bAppend = (data == extData_) && (stride == extStride_) && (n >= end_);
+    unmapSampleFile();
+    attachExternalSamples(data, n, stride, bAppend);
+}
+
+
+bool
+PlotView::mapSampleFile(const std::string& filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        Log::error("PlotView", Log::os() << "Could not open " << filename);
+        return false;
+    }
+
+    struct stat st;
+    void* data = MAP_FAILED;
+    unsigned long size = 0;
+    if ((fstat(fd, &st) == 0) && (st.st_size >= (off_t)sizeof(float)))
+    {
+        size = st.st_size;
+        data = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        Log::error("PlotView", Log::os() << "Could not map " << filename);
+        return false;
+    }
+
+    // The pyramid of the samples mapped before remains valid if the file has
+    // only grown
+    unsigned long n = size / sizeof(float);
+    bool bAppend = mappedData_ && (filename == mappedFile_) && (n >= end_);
+
+    unmapSampleFile();
+    mappedData_ = data;
+    mappedSize_ = size;
+    mappedFile_ = filename;
+    attachExternalSamples(static_cast<const float*>(data), n, 1, bAppend);
+
+    return true;
+}
+
+
+void
+PlotView::clear()
+{
+    unmapSampleFile();
+
+    if (extData_)
+    {
+        // Return to the ring buffer
+        extData_ = 0;
+        extStride_ = 1;
+        for (unsigned int i = ringChunks_; i < chunks_.size(); ++i)
+        {
+            delete chunks_[i];
+        }
+        chunks_.resize(ringChunks_);
+        for (unsigned int i = 0; i != chunks_.size(); ++i)
+        {
+            chunks_[i]->samples.resize(CHUNK_SIZE);
+        }
+    }
+
+    first_ = 0;
+    end_ = 0;
+    dirtyFrom_ = 0;
+}
+
+
+double
+PlotView::getIngestionRate() const
+{
+    return rate_;
+}
+
+
+unsigned long
+PlotView::getFirstSampleIndex() const
+{
+    return first_;
+}
+
+
+unsigned long
+PlotView::getEndSampleIndex() const
+{
+    return end_;
+}
+
+
+float
+PlotView::getSample(unsigned long index) const
+{
+    return extData_
+        ? extData_[index * extStride_]
+        : chunkOf(index).samples[index & CHUNK_MASK];
+}
+
+
+bool
+PlotView::getSampleRange(
+    unsigned long begin,
+    unsigned long end,
+    float& min,
+    float& max) const
+{
+    begin = std::max(begin, first_);
+    end = std::min(end, end_);
+    if (begin >= end)
+    {
+        return false;
+    }
+
+    min = max = getSample(begin);
+
+    // Cover the range with the largest aligned blocks possible
+    unsigned long i = begin;
+    while (i < end)
+    {
+        unsigned int level = 0;
+        while ((level < CHUNK_BITS)
+               && ((i & ((2UL << level) - 1)) == 0)
+               && (i + (2UL << level) <= end))
+        {
+            ++level;
+        }
+
+        if (level == 0)
+        {
+            float v = getSample(i);
+            min = std::min(min, v);
+            max = std::max(max, v);
+        }
+        else
+        {
+            const Chunk& c = chunkOf(i);
+            unsigned int o = levelOffset(level) + ((i & CHUNK_MASK) >> level);
+            min = std::min(min, c.mins[o]);
+            max = std::max(max, c.maxs[o]);
+        }
+
+        i += 1UL << level;
+    }
+
+    return true;
+}
+
+
+void
+PlotView::setSampleSpacing(float dx)
+{
+    if (dx > 0.f)
+    {
+        dx_ = dx;
+    }
+}
+
+
+float
+PlotView::getSampleSpacing() const
+{
+    return dx_;
+}
+
+
+void
+PlotView::setLineColors(const ColorTable& colorTable)
+{
+    lineColorTable_ = colorTable;
+    Color4i defCol(255, 255, 255, 255);
+    if (!lineColorTable_.fgCol)
+    {
+        lineColorTable_.fgCol = new Color4i(defCol);
+    }
+    if (!lineColorTable_.hoveredFgCol)
+    {
+        lineColorTable_.hoveredFgCol = new Color4i(defCol);
+    }
+    if (!lineColorTable_.clickedFgCol)
+    {
+        lineColorTable_.clickedFgCol = new Color4i(defCol);
+    }
+}
+
+
+void
+PlotView::setLineColorScheme(const char* colorScheme)
+{
+    ThemeManager* tm = ThemeManager::getInstance();
+    ColorTable ct;
+    tm->setColors(ct, colorScheme, "PlotView.Line");
+    setLineColors(ct);
+}
+
+
+void
+PlotView::renderOGLContent() const
+{
+    const Point& size = getSize();
+    if ((end_ == first_) || (size.x <= 0))
+    {
+        return;
+    }
+
+    // Visible sample range, including one sample beyond each edge, so the line
+    // reaches the widget borders
+    double left = pxToGLPos(Point(0, 0)).x / dx_;
+    double right = pxToGLPos(Point(size.x, 0)).x / dx_;
+    if ((right < first_) || (left >= end_))
+    {
+        return;
+    }
+    unsigned long begin = std::max(first_,
+        static_cast<unsigned long>(std::max(0., std::floor(left))));
+    unsigned long end = std::min(end_,
+        static_cast<unsigned long>(std::ceil(right)) + 1);
+
+    unsigned int changedFrom = buildVertices(begin, end, (right - left) / size.x);
+    if (vertices_.empty())
+    {
+        return;
+    }
+
+    Color4i* lineCol, *foo;
+    lineColorTable_.queryColors(lineCol, foo, this);
+    setGLColor(lineCol);
+
+    drawVertices(changedFrom);
+}
+
+
+/*static*/
+unsigned int
+PlotView::levelOffset(unsigned int level)
+{
+    return CHUNK_SIZE - (CHUNK_SIZE >> (level - 1));
+}
+
+
+PlotView::Chunk&
+PlotView::chunkOf(unsigned long index) const
+{
+    return *chunks_[(index >> CHUNK_BITS) % chunks_.size()];
+}
+
+
+/*static*/
+void
+PlotView::updatePyramid(
+    Chunk& c,
+    const float* samples,
+    unsigned int stride,
+    unsigned int begin,
+    unsigned int end)
+{
+    // Each level is built from the one below; the loops over complete pairs
+    // are kept simple so the compiler can vectorise them
+    unsigned int b0 = begin >> 1;
+    unsigned int b1 = ((end - 1) >> 1) + 1;
+    unsigned int bFull = std::min(b1, end / 2);
+    float* dstMin = &c.mins[0];
+    float* dstMax = &c.maxs[0];
+    if (stride == 1)
+    {
+        for (unsigned int b = b0; b < bFull; ++b)
+        {
+            dstMin[b] = std::min(samples[2 * b], samples[2 * b + 1]);
+            dstMax[b] = std::max(samples[2 * b], samples[2 * b + 1]);
+        }
+    }
+    else
+    {
+        for (unsigned int b = b0; b < bFull; ++b)
+        {
+            float v0 = samples[2 * b * stride];
+            float v1 = samples[(2 * b + 1) * stride];
+            dstMin[b] = std::min(v0, v1);
+            dstMax[b] = std::max(v0, v1);
+        }
+    }
+    if (bFull < b1)
+    {
+        // The last block only has its first half filled
+        dstMin[bFull] = dstMax[bFull] = samples[2 * bFull * stride];
+    }
+
+    const float* srcMin = dstMin;
+    const float* srcMax = dstMax;
+    for (unsigned int level = 2; level <= CHUNK_BITS; ++level)
+    {
+        // Blocks of this level that are affected, and number of filled entries
+        // of the level below
+        b0 = begin >> level;
+        b1 = ((end - 1) >> level) + 1;
+        unsigned int srcFilled = ((end - 1) >> (level - 1)) + 1;
+
+        dstMin = &c.mins[levelOffset(level)];
+        dstMax = &c.maxs[levelOffset(level)];
+
+        bFull = std::min(b1, srcFilled / 2);
+        for (unsigned int b = b0; b < bFull; ++b)
+        {
+            dstMin[b] = std::min(srcMin[2 * b], srcMin[2 * b + 1]);
+            dstMax[b] = std::max(srcMax[2 * b], srcMax[2 * b + 1]);
+        }
+        if (bFull < b1)
+        {
+            dstMin[bFull] = srcMin[2 * bFull];
+            dstMax[bFull] = srcMax[2 * bFull];
+        }
+
+        srcMin = dstMin;
+        srcMax = dstMax;
+    }
+}
+
+
+void
+PlotView::attachExternalSamples(
+    const float* data,
+    unsigned long n,
+    unsigned int stride,
+    bool bAppend)
+{
+    if (!extData_)
+    {
+        // Samples are read from data from now on, so release the ring buffer's
+        // sample memory (the chunks are kept for their pyramids)
+        for (unsigned int i = 0; i != chunks_.size(); ++i)
+        {
+            std::vector<float>().swap(chunks_[i]->samples);
+        }
+    }
+
+    if (!bAppend)
+    {
+        first_ = 0;
+        end_ = 0;
+    }
+    extData_ = data;
+    extStride_ = stride;
+
+    unsigned long numChunks = (n + CHUNK_MASK) / CHUNK_SIZE;
+    while (chunks_.size() < numChunks)
+    {
+        Chunk* c = new Chunk();
+        c->mins.resize(CHUNK_SIZE - 1);
+        c->maxs.resize(CHUNK_SIZE - 1);
+        chunks_.push_back(c);
+    }
+
+    samplesAdded(end_, n - end_);
+
+    // Build the pyramids of the new samples only
+    while (end_ < n)
+    {
+        unsigned long chunkStart = end_ & ~CHUNK_MASK;
+        unsigned long chunkEnd = std::min(n, chunkStart + CHUNK_SIZE);
+        updatePyramid(chunkOf(end_), data + chunkStart * stride, stride,
+            end_ - chunkStart, chunkEnd - chunkStart);
+        end_ = chunkEnd;
+    }
+}
+
+
+void
+PlotView::unmapSampleFile()
+{
+    if (mappedData_)
+    {
+        munmap(mappedData_, mappedSize_);
+        mappedData_ = 0;
+        mappedSize_ = 0;
+        mappedFile_.clear();
+    }
+}
+
+
+void
+PlotView::samplesAdded(unsigned long begin, unsigned long n)
+{
+    dirtyFrom_ = std::min(dirtyFrom_, begin);
+
+    ingested_ += n;
+    double now = glfwGetTime();
+    if (now - rateStart_ >= 1.0)
+    {
+        rate_ = ingested_ / (now - rateStart_);
+        ingested_ = 0;
+        rateStart_ = now;
+    }
+}
+
+
+unsigned int
+PlotView::buildVertices(
+    unsigned long begin,
+    unsigned long end,
+    double pxSamples) const
+{
+    // Each slot (a sample if few enough samples are visible to draw them
+    // directly, or a pixel column otherwise) gets two vertices
+    bool bDirect = (pxSamples <= 2.);
+    double step = bDirect ? 1. : pxSamples;
+
+    // Align columns to multiples of pxSamples, so they don't change while
+    // panning
+    double start = bDirect ? begin : std::floor(begin / pxSamples) * pxSamples;
+
+    // Slots built for the same view only need to be updated from the first
+    // one that covers samples added since (or the last one, which may have
+    // been incomplete)
+    unsigned long firstSlot = 0;
+    if ((bDirect == bVerticesDirect_) && (step == verticesPxSamples_)
+        && (start == verticesStart_) && (first_ == verticesFirst_))
+    {
+        unsigned long numSlots = vertices_.size() / 2 / (bDirect ? 1 : 2);
+        double dirty = std::max(0., std::floor((dirtyFrom_ - start) / step));
+        firstSlot = std::min<unsigned long>(numSlots > 0 ? numSlots - 1 : 0,
+            static_cast<unsigned long>(dirty));
+    }
+
+    unsigned int slotSize = bDirect ? 2 : 4;
+    vertices_.resize(firstSlot * slotSize);
+
+    bVerticesDirect_ = bDirect;
+    verticesPxSamples_ = step;
+    verticesStart_ = start;
+    verticesFirst_ = first_;
+    dirtyFrom_ = end_;
+
+    if (bDirect)
+    {
+        for (unsigned long i = begin + firstSlot; i < end; ++i)
+        {
+            vertices_.push_back(static_cast<float>(i * double(dx_)));
+            vertices_.push_back(getSample(i));
+        }
+        return firstSlot * slotSize;
+    }
+
+    double a = start + firstSlot * pxSamples;
+    float lastY = (firstSlot > 0) ? vertices_.back() : getSample(begin);
+    while (a < end)
+    {
+        double b = a + pxSamples;
+        unsigned long i0 = static_cast<unsigned long>(std::ceil(a));
+        unsigned long i1 = static_cast<unsigned long>(std::ceil(b));
+
+        float min, max;
+        if (!getSampleRange(i0, i1, min, max))
+        {
+            // Only columns at the start can be empty; a gap would shift the
+            // slot indices, so such columns start the line
+            unsigned long i = std::min(end - 1, std::max(begin, i1 - 1));
+            min = max = lastY = getSample(i);
+        }
+
+        float x = static_cast<float>(std::max<double>(a, begin) * dx_);
+
+        // Continue the line strip from the end closer to the last vertex
+        bool bMaxFirst = (lastY > 0.5f * (min + max));
+        vertices_.push_back(x);
+        vertices_.push_back(bMaxFirst ? max : min);
+        vertices_.push_back(x);
+        vertices_.push_back(bMaxFirst ? min : max);
+        lastY = bMaxFirst ? min : max;
+
+        a = b;
+    }
+
+    return firstSlot * slotSize;
+}
+
+
+void
+PlotView::drawVertices(unsigned int changedFrom) const
+{
+    glEnableClientState(GL_VERTEX_ARRAY);
+
+    if (GLEW_ARB_vertex_buffer_object)
+    {
+        if (!vbo_)
+        {
+            glGenBuffersARB(1, &vbo_);
+        }
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbo_);
+
+        if (vertices_.size() > vboCapacity_)
+        {
+            // Grow the data store; the whole content needs uploading then
+            vboCapacity_ = vertices_.capacity();
+            glBufferDataARB(GL_ARRAY_BUFFER_ARB, vboCapacity_ * sizeof(float),
+                0, GL_DYNAMIC_DRAW_ARB);
+            changedFrom = 0;
+        }
+
+        // Only upload what changed since the last frame
+        if (changedFrom < vertices_.size())
+        {
+            glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,
+                changedFrom * sizeof(float),
+                (vertices_.size() - changedFrom) * sizeof(float),
+                &vertices_[changedFrom]);
+        }
+
+        glVertexPointer(2, GL_FLOAT, 0, 0);
+        glDrawArrays(GL_LINE_STRIP, 0, vertices_.size() / 2);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    }
+    else
+    {
+        glVertexPointer(2, GL_FLOAT, 0, &vertices_[0]);
+        glDrawArrays(GL_LINE_STRIP, 0, vertices_.size() / 2);
+    }
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+
+void
+PlotView::accountMemory(MemoryFootprint& f) const
+{
+    OGLView::accountMemory(f);
+    f.object = sizeof(*this);
+    f.addColors(lineColorTable_);
+    f.text += getHeapSize(mappedFile_);
+    f.buffers += getHeapSize(chunks_) + getHeapSize(vertices_);
+    for (unsigned int i = 0; i != chunks_.size(); ++i)
+    {
+        const Chunk* c = chunks_[i];
+        f.buffers += sizeof(Chunk) + getHeapSize(c->samples)
+            + getHeapSize(c->mins) + getHeapSize(c->maxs);
+    }
+    f.gpu += vboCapacity_ * sizeof(float);
+}
+
+
+} // namespace gw1k
@@ -2,6 +2,7 @@
 
 #include "WManager.h"
 #include "MathHelper.h"
+#include "MemoryReport.h"
 
 #include <iostream>
 #include <cstdlib>
@@ -214,6 +215,7 @@ void
 RangeSlider::setColors(const char* colorScheme)
 {
     std::string baseName(colorScheme ? colorScheme : "RangeSlider");
+    // Also applies the scheme's style, as the name passed is never 0
     AbstractSliderBase::setColors(baseName.c_str());
     std::string hdlName = baseName + ".Handle";
     lHandle_->setColors(hdlName.c_str());
@@ -222,4 +224,13 @@ RangeSlider::setColors(const char* colorScheme)
 }
 
 
+void
+RangeSlider::accountMemory(MemoryFootprint& f) const
+{
+    AbstractSliderBase::accountMemory(f);
+    f.object = sizeof(*this);
+    f.listeners += getHeapSize(actionListeners_);
+}
+
+
 } // namespace gw1k
@@ -0,0 +1,503 @@
+#include "widgets/ScatterView.h"
+
+#include "utils/ShaderHelpers.h"
+#include "MemoryReport.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gw1k
+{
+
+
+namespace
+{
+
+
+const char* VERTEX_SHADER =
+    "#version 120\n"
+    "attribute float pointSize;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_FrontColor = gl_Color;\n"
+    "    gl_PointSize = pointSize;\n"
+    "    gl_Position = ftransform();\n"
+    "}\n";
+
+
+// Draws round points
+const char* FRAGMENT_SHADER =
+    "#version 120\n"
+    "void main()\n"
+    "{\n"
+    "    if (length(gl_PointCoord - vec2(0.5)) > 0.5)\n"
+    "    {\n"
+    "        discard;\n"
+    "    }\n"
+    "    gl_FragColor = gl_Color;\n"
+    "}\n";
+
+
+/** Maximum number of grid cells per axis */
+const int MAX_GRID_SIZE = 2048;
+
+/**
+ * Margin added on each side (relative to the points' extent) when the grid is
+ * rebuilt because points fell outside of it, so growing data only causes a
+ * logarithmic number of rebuilds
+ */
+const float GRID_MARGIN = 0.25f;
+
+
+} // namespace
+
+
+ScatterView::ScatterView(
+    const Point& pos,
+    const Point& size,
+    const char* shadeColorScheme)
+:   OGLView(pos, size, shadeColorScheme),
+    maxSize_(0.f),
+    defaultColor_(255, 255, 255),
+    defaultSize_(4.f),
+    hoveredPoint_(-1),
+    changedFrom_(0),
+    bBuffersCreated_(false),
+    vboCapacity_(0),
+    program_(0),
+    sizeAttrib_(-1),
+    bGridDirty_(true),
+    gridMin_(0.f, 0.f),
+    cellSize_(1.f, 1.f),
+    gridW_(0),
+    gridH_(0),
+    gridPoints_(0),
+    builtPoints_(0)
+{
+    vbos_[0] = vbos_[1] = vbos_[2] = 0;
+    allowMouseControl(true);
+
+    // Picking follows the mouse, so listen to hover events as well
+    removeMouseListener(this);
+    addMouseListener(this, true);
+}
+
+
+ScatterView::~ScatterView()
+{
+    if (vbos_[0])
+    {
+        glDeleteBuffersARB(3, vbos_);
+    }
+    if (program_)
+    {
+        glDeleteProgram(program_);
+    }
+}
+
+
+unsigned int
+ScatterView::addPoint(const geom::Point2D& p, const Color4i& color, float size)
+{
+    unsigned int i = getNumPoints();
+    positions_.push_back(p.x);
+    positions_.push_back(p.y);
+    colors_.push_back(color.r);
+    colors_.push_back(color.g);
+    colors_.push_back(color.b);
+    colors_.push_back(color.a);
+    sizes_.push_back(size);
+    maxSize_ = std::max(maxSize_, size);
+    return i;
+}
+
+
+void
+ScatterView::addPoints(const float* xy, unsigned int n)
+{
+    positions_.insert(positions_.end(), xy, xy + 2 * n);
+    for (unsigned int i = 0; i != n; ++i)
+    {
+        colors_.push_back(defaultColor_.r);
+        colors_.push_back(defaultColor_.g);
+        colors_.push_back(defaultColor_.b);
+        colors_.push_back(defaultColor_.a);
+    }
+    sizes_.insert(sizes_.end(), n, defaultSize_);
+    maxSize_ = std::max(maxSize_, defaultSize_);
+}
+
+
+void
+ScatterView::clear()
+{
+    positions_.clear();
+    colors_.clear();
+    sizes_.clear();
+    maxSize_ = 0.f;
+    changedFrom_ = 0;
+    bGridDirty_ = true;
+    setHoveredPoint(-1);
+}
+
+
+unsigned int
+ScatterView::getNumPoints() const
+{
+    return sizes_.size();
+}
+
+
+geom::Point2D
+ScatterView::getPoint(unsigned int i) const
+{
+    return geom::Point2D(positions_[2 * i], positions_[2 * i + 1]);
+}
+
+
+void
+ScatterView::setPointColor(unsigned int i, const Color4i& color)
+{
+    if (i < getNumPoints())
+    {
+        colors_[4 * i] = color.r;
+        colors_[4 * i + 1] = color.g;
+        colors_[4 * i + 2] = color.b;
+        colors_[4 * i + 3] = color.a;
+        markChanged(i);
+    }
+}
+
+
+void
+ScatterView::setPointSize(unsigned int i, float size)
+{
+    if (i < getNumPoints())
+    {
+        sizes_[i] = size;
+        maxSize_ = std::max(maxSize_, size);
+        markChanged(i);
+    }
+}
+
+
+void
+ScatterView::setDefaultPointColor(const Color4i& color)
+{
+    defaultColor_ = color;
+}
+
+
+void
+ScatterView::setDefaultPointSize(float size)
+{
+    defaultSize_ = size;
+}
+
+
+int
+ScatterView::pickPoint(const Point& relPos, int radius) const
+{
+    if (positions_.empty())
+    {
+        return -1;
+    }
+    updateGrid();
+
+    // Search the cells within the largest possible pick distance
+    geom::Point2D c = pxToGLPos(relPos);
+    geom::Point2D glPerPx = pxToGLUnit(Point(1, 1));
+    float maxDist = radius + 0.5f * maxSize_;
+    float rx = maxDist * std::abs(glPerPx.x);
+    float ry = maxDist * std::abs(glPerPx.y);
+
+    int x0 = std::max(0, int(std::floor((c.x - rx - gridMin_.x) / cellSize_.x)));
+    int x1 = std::min(gridW_ - 1,
+        int(std::floor((c.x + rx - gridMin_.x) / cellSize_.x)));
+    int y0 = std::max(0, int(std::floor((c.y - ry - gridMin_.y) / cellSize_.y)));
+    int y1 = std::min(gridH_ - 1,
+        int(std::floor((c.y + ry - gridMin_.y) / cellSize_.y)));
+
+    int best = -1;
+    float bestDist2 = 0.f;
+    for (int y = y0; y <= y1; ++y)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            for (int i = cellHead_[y * gridW_ + x]; i >= 0; i = nextInCell_[i])
+            {
+                // Distance in pixels
+                float dx = (positions_[2 * i] - c.x) / glPerPx.x;
+                float dy = (positions_[2 * i + 1] - c.y) / glPerPx.y;
+                float dist2 = dx * dx + dy * dy;
+                float r = radius + 0.5f * sizes_[i];
+                if ((dist2 <= r * r) && ((best < 0) || (dist2 < bestDist2)))
+                {
+                    best = i;
+                    bestDist2 = dist2;
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+
+int
+ScatterView::getHoveredPoint() const
+{
+    return hoveredPoint_;
+}
+
+
+void
+ScatterView::mouseMoved(
+    MouseMovedEvent ev,
+    const Point& pos,
+    const Point& delta,
+    GuiObject* receiver)
+{
+    OGLView::mouseMoved(ev, pos, delta, receiver);
+
+    if (receiver == this)
+    {
+        setHoveredPoint((ev == GW1K_M_LEFT)
+            ? -1 : pickPoint(pos - getGlobalPos()));
+    }
+}
+
+
+void
+ScatterView::renderOGLContent() const
+{
+    if (positions_.empty())
+    {
+        return;
+    }
+
+    bool bVbo = GLEW_ARB_vertex_buffer_object;
+    if (!bBuffersCreated_)
+    {
+        bBuffersCreated_ = true;
+        program_ = createShaderProgram(VERTEX_SHADER, FRAGMENT_SHADER,
+            "ScatterView");
+        if (program_)
+        {
+            sizeAttrib_ = glGetAttribLocation(program_, "pointSize");
+        }
+        if (bVbo)
+        {
+            glGenBuffersARB(3, vbos_);
+        }
+    }
+    if (bVbo)
+    {
+        uploadPoints();
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    if (bVbo)
+    {
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbos_[0]);
+        glVertexPointer(2, GL_FLOAT, 0, 0);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbos_[1]);
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, 0);
+    }
+    else
+    {
+        glVertexPointer(2, GL_FLOAT, 0, &positions_[0]);
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colors_[0]);
+    }
+
+    if (program_ && (sizeAttrib_ >= 0))
+    {
+        glUseProgram(program_);
+        glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+        glEnableVertexAttribArray(sizeAttrib_);
+        if (bVbo)
+        {
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbos_[2]);
+            glVertexAttribPointer(sizeAttrib_, 1, GL_FLOAT, GL_FALSE, 0, 0);
+        }
+        else
+        {
+            glVertexAttribPointer(sizeAttrib_, 1, GL_FLOAT, GL_FALSE, 0,
+                &sizes_[0]);
+        }
+
+        glDrawArrays(GL_POINTS, 0, getNumPoints());
+
+        glDisableVertexAttribArray(sizeAttrib_);
+        glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+        glUseProgram(0);
+    }
+    else
+    {
+        glPointSize(defaultSize_);
+        glDrawArrays(GL_POINTS, 0, getNumPoints());
+        glPointSize(1.f);
+    }
+
+    if (bVbo)
+    {
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    }
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+
+void
+ScatterView::updateGrid() const
+{
+    unsigned int n = getNumPoints();
+    if (bGridDirty_ || (n > 2 * builtPoints_))
+    {
+        buildGrid(0.f);
+        return;
+    }
+
+    nextInCell_.resize(n);
+    for (unsigned int i = gridPoints_; i != n; ++i)
+    {
+        float x = std::floor((positions_[2 * i] - gridMin_.x) / cellSize_.x);
+        float y = std::floor((positions_[2 * i + 1] - gridMin_.y) / cellSize_.y);
+        if ((x < 0.f) || (x >= gridW_) || (y < 0.f) || (y >= gridH_))
+        {
+            buildGrid(GRID_MARGIN);
+            return;
+        }
+
+        int cell = int(y) * gridW_ + int(x);
+        nextInCell_[i] = cellHead_[cell];
+        cellHead_[cell] = i;
+    }
+    gridPoints_ = n;
+}
+
+
+void
+ScatterView::buildGrid(float margin) const
+{
+    bGridDirty_ = false;
+
+    unsigned int n = getNumPoints();
+    geom::Point2D min(positions_[0], positions_[1]);
+    geom::Point2D max = min;
+    for (unsigned int i = 1; i < n; ++i)
+    {
+        min.x = std::min(min.x, positions_[2 * i]);
+        max.x = std::max(max.x, positions_[2 * i]);
+        min.y = std::min(min.y, positions_[2 * i + 1]);
+        max.y = std::max(max.y, positions_[2 * i + 1]);
+    }
+
+    float w = std::max(max.x - min.x, 1e-6f);
+    float h = std::max(max.y - min.y, 1e-6f);
+    min.x -= margin * w;
+    min.y -= margin * h;
+    w *= 1.f + 2.f * margin;
+    h *= 1.f + 2.f * margin;
+
+    // Aim at about two points per cell for evenly spread points
+    float cellArea = 2.f * w * h / n;
+    float cellEdge = std::sqrt(cellArea);
+    gridW_ = std::max(1, std::min(MAX_GRID_SIZE, int(std::ceil(w / cellEdge))));
+    gridH_ = std::max(1, std::min(MAX_GRID_SIZE, int(std::ceil(h / cellEdge))));
+    gridMin_ = min;
+
+    // Slightly enlarge cells so points on the max edge fall into the last cell
+    cellSize_ = geom::Point2D(w * 1.0001f / gridW_, h * 1.0001f / gridH_);
+
+    cellHead_.assign(gridW_ * gridH_, -1);
+    nextInCell_.resize(n);
+    for (unsigned int i = 0; i != n; ++i)
+    {
+        int x = int((positions_[2 * i] - min.x) / cellSize_.x);
+        int y = int((positions_[2 * i + 1] - min.y) / cellSize_.y);
+        int cell = std::min(y, gridH_ - 1) * gridW_ + std::min(x, gridW_ - 1);
+        nextInCell_[i] = cellHead_[cell];
+        cellHead_[cell] = i;
+    }
+
+    gridPoints_ = n;
+    builtPoints_ = n;
+}
+
+
+void
+ScatterView::markChanged(unsigned int i)
+{
+    changedFrom_ = std::min(changedFrom_, i);
+}
+
+
+void
+ScatterView::uploadPoints() const
+{
+    unsigned int n = getNumPoints();
+    if (n > vboCapacity_)
+    {
+        // Grow the data stores (which requires uploading everything)
+        vboCapacity_ = std::max(n, 2 * vboCapacity_);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbos_[0]);
+        glBufferDataARB(GL_ARRAY_BUFFER_ARB,
+            vboCapacity_ * 2 * sizeof(float), 0, GL_DYNAMIC_DRAW_ARB);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbos_[1]);
+        glBufferDataARB(GL_ARRAY_BUFFER_ARB,
+            vboCapacity_ * 4, 0, GL_DYNAMIC_DRAW_ARB);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbos_[2]);
+        glBufferDataARB(GL_ARRAY_BUFFER_ARB,
+            vboCapacity_ * sizeof(float), 0, GL_DYNAMIC_DRAW_ARB);
+        changedFrom_ = 0;
+    }
+
+    if (changedFrom_ < n)
+    {
+        unsigned int m = n - changedFrom_;
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbos_[0]);
+        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,
+            changedFrom_ * 2 * sizeof(float), m * 2 * sizeof(float),
+            &positions_[2 * changedFrom_]);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbos_[1]);
+        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,
+            changedFrom_ * 4, m * 4, &colors_[4 * changedFrom_]);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbos_[2]);
+        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,
+            changedFrom_ * sizeof(float), m * sizeof(float),
+            &sizes_[changedFrom_]);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    }
+    changedFrom_ = n;
+}
+
+
+void
+ScatterView::setHoveredPoint(int i)
+{
+    if (i != hoveredPoint_)
+    {
+        hoveredPoint_ = i;
+        informActionListeners(this);
+    }
+}
+
+
+void
+ScatterView::accountMemory(MemoryFootprint& f) const
+{
+    OGLView::accountMemory(f);
+    f.object = sizeof(*this);
+    f.listeners += getHeapSize(actionListeners_);
+    f.buffers += getHeapSize(positions_) + getHeapSize(colors_)
+        + getHeapSize(sizes_) + getHeapSize(cellHead_)
+        + getHeapSize(nextInCell_);
+    // Positions, colours and sizes
+    f.gpu += vboCapacity_ * (3 * sizeof(float) + 4);
+}
+
+
+} // namespace gw1k
@@ -2,6 +2,7 @@
 #include "widgets/ClippingBox.h"
 #include "widgets/Label.h"
 #include "ThemeManager.h"
+#include "MemoryReport.h"
 
 namespace gw1k
 {
@@ -82,6 +83,15 @@ ScrollPane::removeSubObject(GuiObject* o)
 }
 
 
+void
+ScrollPane::removeSubObjects(const std::vector<GuiObject*>& objects)
+{
+    Point objsFit = pane_->getAccommodationStatus();
+    pane_->removeSubObjects(objects);
+    revalidatePaneAndSliders(objsFit != pane_->getAccommodationStatus());
+}
+
+
 void
 ScrollPane::removeAndDeleteAllSubObjects()
 {
@@ -123,16 +133,40 @@ ScrollPane::refreshLayout()
 }
 
 
+void
+ScrollPane::refreshLayout(GuiObject* o)
+{
+    Point objsFit = pane_->getAccommodationStatus();
+    pane_->updateSubObjectBounds(o);
+    revalidatePaneAndSliders(objsFit != pane_->getAccommodationStatus());
+}
+
+
 void
 ScrollPane::setColors(const char* colorScheme)
 {
     std::string baseName(colorScheme ? colorScheme : "ScrollPane");
     ThemeManager::getInstance()->setColors(this, colorScheme, "ScrollPane");
+    setStyle(colorScheme, "ScrollPane");
     hSlider_->setColors((baseName + ".HSlider").c_str());
     vSlider_->setColors((baseName + ".VSlider").c_str());
 }
 
 
+void
+ScrollPane::setScrollCaching(bool enabled)
+{
+    pane_->setScrollCaching(enabled);
+}
+
+
+void
+ScrollPane::invalidateScrollCache()
+{
+    pane_->invalidateScrollCache();
+}
+
+
 const Point&
 ScrollPane::getVisibleSize() const
 {
@@ -279,4 +313,12 @@ ScrollPane::revalidatePaneAndSliders(bool accommodationStateChanged)
 }
 
 
+void
+ScrollPane::accountMemory(MemoryFootprint& f) const
+{
+    WiBox::accountMemory(f);
+    f.object = sizeof(*this);
+}
+
+
 } // namespace gw1k
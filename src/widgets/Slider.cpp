@@ -5,6 +5,7 @@
 #include "Color4i.h"
 #include "ThemeManager.h"
 #include "Log.h"
+#include "MemoryReport.h"
 
 #include <algorithm>
 #include <iostream>
@@ -178,6 +179,7 @@ void
 Slider::setColors(const char* colorScheme)
 {
     std::string baseName(colorScheme ? colorScheme : "Slider");
+    // Also applies the scheme's style, as the name passed is never 0
     AbstractSliderBase::setColors(baseName.c_str());
     std::string hdlName = baseName + ".Handle";
     handle_->setColors(hdlName.c_str());
@@ -265,4 +267,13 @@ Slider::calculateHandlePos() const
 }
 
 
+void
+Slider::accountMemory(MemoryFootprint& f) const
+{
+    AbstractSliderBase::accountMemory(f);
+    f.object = sizeof(*this);
+    f.listeners += getHeapSize(actionListeners_);
+}
+
+
 } // namespace gw1k
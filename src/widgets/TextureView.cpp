@@ -4,6 +4,7 @@
 #include "WManager.h"
 #include "Render.h"
 #include "Log.h"
+#include "MemoryReport.h"
 
 #include <cstring>
 
@@ -197,4 +198,18 @@ TextureView::setSize(float width, float height)
 }
 
 
+void
+TextureView::accountMemory(MemoryFootprint& f) const
+{
+    OGLView::accountMemory(f);
+    f.object = sizeof(*this);
+    f.text += getHeapSize(filename_);
+    if (pTex_)
+    {
+        f.buffers += sizeof(GLuint);
+        f.gpu += imgSize_.x * imgSize_.y * (imgAlpha_ ? 4 : 3);
+    }
+}
+
+
 } // namespace gw1k
@@ -1,5 +1,7 @@
 #include "widgets/TextureWiBox.h"
 
+#include "MemoryReport.h"
+
 namespace gw1k
 {
 
@@ -96,4 +98,12 @@ TextureWiBox::getTextureSize() const
 }
 
 
+void
+TextureWiBox::accountMemory(MemoryFootprint& f) const
+{
+    WiBox::accountMemory(f);
+    f.object = sizeof(*this);
+}
+
+
 } // namespace gw1k
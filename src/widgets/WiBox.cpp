@@ -3,15 +3,19 @@
 #include "utils/Helpers.h"
 #include "Render.h"
 #include "ThemeManager.h"
+#include "MemoryReport.h"
 
 #include <iostream>
+#include <string>
 
 namespace gw1k
 {
 
 
 WiBox::WiBox(const Point& pos, const Point& size, const char* colorScheme)
-:   Box(pos, size)
+:   Box(pos, size),
+    cornerRadius_(0.f),
+    borderWidth_(1.f)
 {
     setColors(colorScheme);
 }
@@ -24,6 +28,18 @@ WiBox::~WiBox()
 void
 WiBox::renderFg(const Point& offset) const
 {
+    if (isStyled())
+    {
+        // If there is a background, the border was drawn along with it
+        Color4i* fg, * bg;
+        selectColors(fg, bg);
+        if (!bg)
+        {
+            renderStyled(offset, false);
+        }
+        return;
+    }
+
     Point pos = getPos() + offset;
     Point last = pos + getSize() - Point(1, 1);
     //std::cout << getPos() << ", " << getSize() << " [pos + offset = " << pos << "]" << std::endl;
@@ -34,6 +50,12 @@ WiBox::renderFg(const Point& offset) const
 void
 WiBox::renderBg(const Point& offset) const
 {
+    if (isStyled())
+    {
+        renderStyled(offset, true);
+        return;
+    }
+
     Point pos = getPos() + offset;
     // OpenGL will render Quads one pixel too small on the right and bottom
     // edges if we give it the last pixel, so give it the end (which does not
@@ -47,6 +69,100 @@ void
 WiBox::setColors(const char* colorScheme)
 {
     ThemeManager::getInstance()->setColors(this, colorScheme, "WiBox");
+    setStyle(colorScheme, "WiBox");
+}
+
+
+void
+WiBox::setCornerRadius(float radius)
+{
+    cornerRadius_ = radius;
+}
+
+
+float
+WiBox::getCornerRadius() const
+{
+    return cornerRadius_;
+}
+
+
+void
+WiBox::setBorderWidth(float width)
+{
+    borderWidth_ = width;
+}
+
+
+float
+WiBox::getBorderWidth() const
+{
+    return borderWidth_;
+}
+
+
+void
+WiBox::setGradientColors(const ColorTable& ct)
+{
+    gradientColors_ = ct;
+}
+
+
+const ColorTable&
+WiBox::getGradientColors() const
+{
+    return gradientColors_;
+}
+
+
+void
+WiBox::setStyle(const char* colorScheme, const char* fallbackScheme)
+{
+    ThemeManager* tm = ThemeManager::getInstance();
+    cornerRadius_ = tm->getStyleValue("radius", colorScheme, fallbackScheme, 0.f);
+    borderWidth_ = tm->getStyleValue("border", colorScheme, fallbackScheme, 1.f);
+
+    std::string gradientScheme(colorScheme ? colorScheme : fallbackScheme);
+    gradientScheme.append(".Gradient");
+    tm->setColors(gradientColors_, gradientScheme.c_str(), 0);
+}
+
+
+bool
+WiBox::isStyled() const
+{
+    return (cornerRadius_ > 0.f) || (borderWidth_ != 1.f)
+        || gradientColors_.bgCol || gradientColors_.hoveredBgCol
+        || gradientColors_.clickedBgCol;
+}
+
+
+void
+WiBox::renderStyled(const Point& offset, bool bFill) const
+{
+    Color4i* fg, * bg, * foo, * gradient;
+    selectColors(fg, bg);
+    gradientColors_.queryColors(foo, gradient, this);
+
+    BoxStyle style;
+    style.cornerRadius = cornerRadius_;
+    style.borderWidth = borderWidth_;
+    style.fillColor = bFill ? bg : 0;
+    style.gradientColor = bFill ? gradient : 0;
+    style.borderColor = fg;
+
+    Point pos = getPos() + offset;
+    Point end = getEnd() + offset;
+    drawStyledRect(pointToGeomPoint2D(pos), pointToGeomPoint2D(end), style);
+}
+
+
+void
+WiBox::accountMemory(MemoryFootprint& f) const
+{
+    Box::accountMemory(f);
+    f.object = sizeof(*this);
+    f.addColors(gradientColors_);
 }
 
 
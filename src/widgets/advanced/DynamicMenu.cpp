@@ -1,6 +1,7 @@
 #include "widgets/advanced/DynamicMenu.h"
 
 #include "WManager.h"
+#include "MemoryReport.h"
 
 namespace gw1k
 {
@@ -76,4 +77,12 @@ DynamicMenu::removeAllEntries()
 }
 
 
+void
+DynamicMenu::accountMemory(MemoryFootprint& f) const
+{
+    Menu::accountMemory(f);
+    f.object = sizeof(*this);
+}
+
+
 } // namespace gw1k
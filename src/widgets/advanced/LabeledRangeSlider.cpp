@@ -2,6 +2,7 @@
 
 #include "utils/StringHelpers.h"
 #include "MathHelper.h"
+#include "MemoryReport.h"
 
 #include <cstdlib>
 
@@ -174,4 +175,13 @@ LabeledRangeSlider::updateLabels()
 }
 
 
+void
+LabeledRangeSlider::accountMemory(MemoryFootprint& f) const
+{
+    Box::accountMemory(f);
+    f.object = sizeof(*this);
+    f.listeners += getHeapSize(actionListeners_);
+}
+
+
 } // namespace gw1k
@@ -1,6 +1,9 @@
 #include "widgets/advanced/NumberLabel.h"
 
-#include "utils/StringHelpers.h"
+#include "utils/NumberFormat.h"
+#include "MemoryReport.h"
+
+#include <algorithm>
 
 
 namespace gw1k
@@ -16,7 +19,8 @@ NumberLabel::NumberLabel(
 :   Label(pos, size, "", autoSize, colorScheme),
     number_(number),
     precision_(3),
-    numberSpace_(0)
+    numberSpace_(0),
+    bFormatted_(false)
 {
     setNumber(number);
 }
@@ -35,7 +39,8 @@ NumberLabel::NumberLabel(
     precision_(3),
     preamble_(preamble),
     unit_(unit),
-    numberSpace_(0)
+    numberSpace_(0),
+    bFormatted_(false)
 {
     setNumber(number);
 }
@@ -51,41 +56,82 @@ void
 NumberLabel::setPrecision(int precision)
 {
     precision_ = std::max(precision, 0);
-    setNumber(number_);
+    refreshText();
 }
 
 
 void
 NumberLabel::setNumber(float number)
 {
+    // Nothing to do if the displayed value doesn't change, which is common
+    // for values bound to slowly changing sources
+    if (bFormatted_ && (number == number_))
+    {
+        return;
+    }
+
     number_ = number;
+    refreshText();
+}
+
 
-    std::string n = toStr(number);
-    std::stringstream s;
-    s << preamble_;
-    if (numberSpace_ > n.length())
+float
+NumberLabel::getNumber() const
+{
+    return number_;
+}
+
+
+void
+NumberLabel::refreshText()
+{
+    char n[NUMBER_FORMAT_BUFSIZE];
+    unsigned int len = formatFixed(number_, precision_, n);
+
+    textBuf_ = preamble_;
+    if (numberSpace_ > len)
     {
-        s.width(numberSpace_);
+        textBuf_.append(numberSpace_ - len, ' ');
     }
-    s << std::right << n << unit_;
+    textBuf_.append(n, len);
+    textBuf_.append(unit_);
+
+    bFormatted_ = true;
 
-    setText(s.str());
+    // Formatting is cheap; the text goes through Label::setText() so it is
+    // latched like any other text, and the last of setText() and setNumber()
+    // wins
+    Label::setText(textBuf_);
 }
 
 
 void
 NumberLabel::setNumber(int number)
 {
-    setPrecision(0);
+    if (precision_ != 0)
+    {
+        precision_ = 0;
+        bFormatted_ = false;
+    }
     setNumber(static_cast<float>(number));
 }
 
 
+void
+NumberLabel::setText(const std::string& text)
+{
+    // The number is no longer displayed, so setting it again must not be
+    // skipped
+    bFormatted_ = false;
+    Label::setText(text);
+}
+
+
 void
 NumberLabel::setPreamble(const std::string& preamble)
 {
     preamble_ = preamble;
-    setNumber(number_);
+    refreshText();
 }
 
 
@@ -93,7 +139,7 @@ void
 NumberLabel::setUnit(const std::string& unit)
 {
     unit_ = unit;
-    setNumber(number_);
+    refreshText();
 }
 
 
@@ -101,15 +147,17 @@ void
 NumberLabel::setNumberSpace(int n)
 {
     numberSpace_ = n;
-    setNumber(number_);
-
+    refreshText();
 }
 
 
-std::string
-NumberLabel::toStr(float f) const
+void
+NumberLabel::accountMemory(MemoryFootprint& f) const
 {
-    return toString(f, precision_);
+    Label::accountMemory(f);
+    f.object = sizeof(*this);
+    f.text += getHeapSize(preamble_) + getHeapSize(unit_)
+        + getHeapSize(textBuf_);
 }
 
 
@@ -2,6 +2,7 @@
 
 #include "Log.h"
 #include "MathHelper.h"
+#include "MemoryReport.h"
 
 namespace gw1k
 {
@@ -67,4 +68,12 @@ AbstractSliderBase::getUnmappedValue(float rangeVal) const
 }
 
 
+void
+AbstractSliderBase::accountMemory(MemoryFootprint& f) const
+{
+    WiBox::accountMemory(f);
+    f.object = sizeof(*this);
+}
+
+
 } // namespace gw1k
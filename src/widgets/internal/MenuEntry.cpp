@@ -1,6 +1,7 @@
 #include "widgets/internal/MenuEntry.h"
 
 #include "widgets/Menu.h"
+#include "MemoryReport.h"
 
 namespace gw1k
 {
@@ -85,4 +86,12 @@ MenuEntry::setColors(const char* colorScheme)
 }
 
 
+void
+MenuEntry::accountMemory(MemoryFootprint& f) const
+{
+    Label::accountMemory(f);
+    f.object = sizeof(*this);
+}
+
+
 } // namespace gw1k
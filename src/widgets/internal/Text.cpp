@@ -6,6 +6,8 @@
 #include "WManager.h"
 #include "ThemeManager.h"
 #include "MathHelper.h"
+#include "RenderPipeline.h"
+#include "MemoryReport.h"
 
 #include <GL/glew.h>
 
@@ -17,6 +19,18 @@ namespace gw1k
 {
 
 
+TextLayout::TextLayout()
+:   faceSize(0),
+    font(0),
+    fontScale(0.f),
+    bLineLengthSet(false),
+    width(0)
+{}
+
+
+/*static*/ bool Text::bFontLookupsDeferred_(false);
+
+
 Text::Text(
     const Point& pos,
     const std::string& text,
@@ -26,7 +40,9 @@ Text::Text(
     layout_(new FTSimpleLayout()),
     size_(0, 0),
     bLineLengthSet_(false),
-    fontName_(Gw1kSettings::defaultFontName)
+    fontName_(Gw1kSettings::defaultFontName),
+    faceSize_(0),
+    fontScale_(1.f)
 {
     typedef Gw1kSettings GS;
 
@@ -45,6 +61,10 @@ Text::Text(
 
 Text::~Text()
 {
+    if (font_)
+    {
+        FTGLFontManager::Instance().ReleaseFont(font_);
+    }
     delete layout_;
 }
 
@@ -77,7 +97,7 @@ Text::setFontSize(unsigned int fontSize)
 int
 Text::getFontSize() const
 {
-    return font_ ? font_->FaceSize() : -1;
+    return font_ ? static_cast<int>(faceSize_) : -1;
 }
 
 
@@ -85,12 +105,99 @@ void
 Text::setFont(const std::string& name, unsigned int faceSize)
 {
     fontName_ = name;
-    font_ = FTGLFontManager::Instance().GetFont(name.c_str(), faceSize);
+    if (bFontLookupsDeferred_)
+    {
+        faceSize_ = faceSize;
+        return;
+    }
+
+    FTGLFontManager& fm = FTGLFontManager::Instance();
+    float scale;
+    FTFont* font = fm.GetRenderFont(name.c_str(), faceSize, scale);
+    if (font_ && (font == font_) && (scale == fontScale_))
+    {
+        // Same face and size; nothing to re-measure
+        return;
+    }
+    if (font)
+    {
+        fm.AcquireFont(font);
+    }
+    if (font_)
+    {
+        fm.ReleaseFont(font_);
+    }
+    font_ = font;
+    faceSize_ = faceSize;
+    fontScale_ = scale;
     layout_->SetFont(font_);
     update();
 }
 
 
+const std::string&
+Text::getFontName() const
+{
+    return fontName_;
+}
+
+
+void
+Text::getLayout(TextLayout& layout) const
+{
+    layout.fontName = fontName_;
+    layout.faceSize = faceSize_;
+    layout.font = font_;
+    layout.fontScale = font_ ? fontScale_ : 0.f;
+    layout.bbox = ftBB_;
+    layout.bLineLengthSet = bLineLengthSet_;
+    layout.width = size_.x;
+}
+
+
+void
+Text::restoreLayout(const TextLayout& layout)
+{
+    FTGLFontManager& fm = FTGLFontManager::Instance();
+    if (layout.font)
+    {
+        fm.AcquireFont(layout.font);
+    }
+    if (font_)
+    {
+        fm.ReleaseFont(font_);
+    }
+    font_ = layout.font;
+    fontName_ = layout.fontName;
+    faceSize_ = layout.faceSize;
+    fontScale_ = font_ ? layout.fontScale : 1.f;
+    layout_->SetFont(font_);
+
+    bLineLengthSet_ = layout.bLineLengthSet;
+    if (bLineLengthSet_)
+    {
+        size_.x = GuiObject::setSize(layout.width, GuiObject::getSize().y).x;
+        layout_->SetLineLength(size_.x / fontScale_);
+    }
+    else
+    {
+        layout_->SetLineLength(999999.f);
+    }
+
+    ftBB_ = layout.bbox;
+    updateWidth();
+    updateHeight();
+}
+
+
+/*static*/
+void
+Text::setFontLookupsDeferred(bool state)
+{
+    bFontLookupsDeferred_ = state;
+}
+
+
 void
 Text::setHorizontalAlignment(TextProperty alignment)
 {
@@ -112,8 +219,11 @@ Text::setHorizontalAlignment(TextProperty alignment)
         break;
     }
 
-    layout_->SetAlignment(ftglAlignment);
-    updateBBox();
+    if (layout_->GetAlignment() != ftglAlignment)
+    {
+        layout_->SetAlignment(ftglAlignment);
+        updateBBox();
+    }
 }
 
 
@@ -134,7 +244,7 @@ Text::setSize(float width, float height)
     {
         bLineLengthSet_ = true;
         size_.x = GuiObject::setSize(width, height).x;
-        layout_->SetLineLength(size_.x);
+        layout_->SetLineLength(size_.x / fontScale_);
     }
 
     updateBBox();
@@ -157,7 +267,7 @@ Text::renderFg(const Point& offset) const
 {
     if (font_ && !text_.empty())
     {
-        glPushMatrix();
+        pushTransform();
         {
             // We have to tinker a little with the Y coordinate because FTGL
             // assumes the default OpenGL default coordinate system with X and Y
@@ -178,18 +288,22 @@ Text::renderFg(const Point& offset) const
             // text is then located somewhere far from our screen); if line
             // length is set, there's no need to neutralise (because the text
             // should be on-screen usually)
-            float x = t.x + (bLineLengthSet_ ? 0 : -ftBB_.Lower().Xf());
+            float x = t.x
+                + (bLineLengthSet_ ? 0 : -ftBB_.Lower().Xf() * fontScale_);
 
             // We need to add the text's upper y extent to our y-offset; this
             // translates the text the correct (from our point of view) baseline
             // (try leaving it out, the text will be displaced)
-            float y = t.y + ftBB_.Upper().Yf();
+            float y = t.y + ftBB_.Upper().Yf() * fontScale_;
+
+            translateTransform(x, y);
+            scaleTransform(fontScale_, -fontScale_);
 
-            glTranslatef(x, y, 0.f);
-            glScalef(1.f, -1.f, 1.f);
+            // FTGL renders with the fixed-function pipeline
+            syncFixedFunctionTransform();
             layout_->Render(text_.c_str());
         }
-        glPopMatrix();
+        popTransform();
     }
 }
 
@@ -218,14 +332,16 @@ Text::setColors(const char* colorScheme)
 void
 Text::updateBBox()
 {
-    ftBB_ = (font_ && !text_.empty()) ? layout_->BBox(text_.c_str()) : FTBBox();
+    ftBB_ = (font_ && !text_.empty())
+        ? FTGLFontManager::Instance().MeasureText(*layout_, text_) : FTBBox();
 }
 
 
 void
 Text::updateHeight()
 {
-    size_.y = std::ceil(std::abs(ftBB_.Lower().Yf() - ftBB_.Upper().Yf()));
+    size_.y = std::ceil(
+        std::abs(ftBB_.Lower().Yf() - ftBB_.Upper().Yf()) * fontScale_);
 }
 
 
@@ -234,11 +350,12 @@ Text::updateWidth()
 {
     if (bLineLengthSet_)
     {
-        size_.x = layout_->GetLineLength();
+        size_.x = layout_->GetLineLength() * fontScale_;
     }
     else
     {
-        size_.x = std::ceil(std::abs(ftBB_.Lower().Xf() - ftBB_.Upper().Xf()));
+        size_.x = std::ceil(
+            std::abs(ftBB_.Lower().Xf() - ftBB_.Upper().Xf()) * fontScale_);
     }
 }
 
@@ -250,4 +367,22 @@ Text::update()
 }
 
 
+void
+Text::accountMemory(MemoryFootprint& f) const
+{
+    Renderable::accountMemory(f);
+    f.object = sizeof(*this);
+    f.text += getHeapSize(text_) + getHeapSize(fontName_);
+    if (layout_)
+    {
+        // Only the FTSimpleLayout object; see MemoryFootprint::text
+        f.text += sizeof(*layout_);
+    }
+    if (font_)
+    {
+        f.fonts.insert(font_);
+    }
+}
+
+
 } // namespace gw1k